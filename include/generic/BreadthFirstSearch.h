@@ -0,0 +1,222 @@
+#ifndef BREADTH_FIRST_SEARCH_H_
+#define BREADTH_FIRST_SEARCH_H_
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Breadth-first search over any index graph that provides size() and
+// forEachNeighbor(v, fn(to, weight)). Visited vertices are kept in a bitset
+// and the search writes flat outputs: the visit order, the offsets in that
+// order where each level starts and, on request, every vertex's level and
+// BFS tree parent. A visitor is called as visit(vertex, level, parent) when
+// a vertex is discovered; if it returns bool, false ends the search.
+template<class GraphType>
+class BreadthFirstSearch
+{
+public:
+  using Index = std::uint32_t;
+
+  static constexpr Index NoVertex = UINT32_MAX;
+
+  static constexpr int Unreached = -1;
+
+  explicit BreadthFirstSearch(const GraphType& graph);
+
+  void run(Index source, bool withTree = false);
+
+  template<class Visitor>
+  void run(Index source, Visitor visit, bool withTree = false);
+
+  bool visited(Index vertex) const;
+
+  const std::vector<Index>& order() const;
+
+  const std::vector<std::size_t>& levelOffsets() const;
+
+  const std::vector<int>& levels() const;
+
+  const std::vector<Index>& parents() const;
+
+  std::vector<Index> takeOrder();
+
+  std::vector<int> takeLevels();
+
+  std::vector<Index> takeParents();
+
+private:
+  bool mark(Index vertex);
+
+  const GraphType& _graph;
+
+  std::vector<std::uint64_t> _visited;
+
+  std::vector<Index> _order;
+
+  std::vector<std::size_t> _levelOffsets;
+
+  std::vector<int> _levels;
+
+  std::vector<Index> _parents;
+};
+
+template<class GraphType>
+BreadthFirstSearch<GraphType>::BreadthFirstSearch(const GraphType& graph)
+  : _graph(graph)
+{
+}
+
+template<class GraphType>
+void
+BreadthFirstSearch<GraphType>::run(Index source, bool withTree)
+{
+  run(source, [](Index, int, Index) {}, withTree);
+}
+
+template<class GraphType>
+template<class Visitor>
+void
+BreadthFirstSearch<GraphType>::run(Index source, Visitor visit, bool withTree)
+{
+  // a visitor returning void never stops the search
+  auto proceed = [&](Index vertex, int level, Index parent) {
+    if constexpr (std::is_same<decltype(visit(vertex, level, parent)),
+                               bool>::value) {
+      return visit(vertex, level, parent);
+    } else {
+      visit(vertex, level, parent);
+      return true;
+    }
+  };
+
+  _visited.assign((_graph.size() + 63) / 64, 0);
+  _order.clear();
+  _levelOffsets.assign(1, 0);
+  _levels.clear();
+  _parents.clear();
+
+  if (withTree) {
+    _levels.assign(_graph.size(), Unreached);
+    _parents.assign(_graph.size(), NoVertex);
+  }
+
+  if (source >= _graph.size()) {
+    return;
+  }
+
+  mark(source);
+  _order.push_back(source);
+
+  if (withTree) {
+    _levels[source] = 0;
+  }
+
+  bool stopped = !proceed(source, 0, NoVertex);
+  std::size_t levelEnd = 1;
+  int level = 0;
+
+  for (std::size_t head = 0; head < _order.size() && !stopped; head += 1) {
+    if (head == levelEnd) {
+      _levelOffsets.push_back(head);
+      levelEnd = _order.size();
+      level += 1;
+    }
+
+    auto from = _order[head];
+
+    _graph.forEachNeighbor(from, [&](Index to, auto) {
+      if (stopped || !mark(to)) {
+        return;
+      }
+
+      _order.push_back(to);
+
+      if (withTree) {
+        _levels[to] = level + 1;
+        _parents[to] = from;
+      }
+
+      stopped = !proceed(to, level + 1, from);
+    });
+  }
+
+  if (_levelOffsets.back() != _order.size()) {
+    _levelOffsets.push_back(_order.size());
+  }
+}
+
+template<class GraphType>
+bool
+BreadthFirstSearch<GraphType>::visited(Index vertex) const
+{
+  return (_visited[vertex / 64] >> (vertex % 64)) & 1;
+}
+
+template<class GraphType>
+const std::vector<typename BreadthFirstSearch<GraphType>::Index>&
+BreadthFirstSearch<GraphType>::order() const
+{
+  return _order;
+}
+
+template<class GraphType>
+const std::vector<std::size_t>&
+BreadthFirstSearch<GraphType>::levelOffsets() const
+{
+  return _levelOffsets;
+}
+
+template<class GraphType>
+const std::vector<int>&
+BreadthFirstSearch<GraphType>::levels() const
+{
+  return _levels;
+}
+
+template<class GraphType>
+const std::vector<typename BreadthFirstSearch<GraphType>::Index>&
+BreadthFirstSearch<GraphType>::parents() const
+{
+  return _parents;
+}
+
+template<class GraphType>
+std::vector<typename BreadthFirstSearch<GraphType>::Index>
+BreadthFirstSearch<GraphType>::takeOrder()
+{
+  return std::move(_order);
+}
+
+template<class GraphType>
+std::vector<int>
+BreadthFirstSearch<GraphType>::takeLevels()
+{
+  return std::move(_levels);
+}
+
+template<class GraphType>
+std::vector<typename BreadthFirstSearch<GraphType>::Index>
+BreadthFirstSearch<GraphType>::takeParents()
+{
+  return std::move(_parents);
+}
+
+// sets the bit of vertex and tells whether it was clear before
+template<class GraphType>
+bool
+BreadthFirstSearch<GraphType>::mark(Index vertex)
+{
+  auto& word = _visited[vertex / 64];
+  std::uint64_t bit = std::uint64_t(1) << (vertex % 64);
+
+  if (word & bit) {
+    return false;
+  }
+
+  word |= bit;
+
+  return true;
+}
+
+#endif // BreadthFirstSearch.h included
@@ -0,0 +1,161 @@
+#ifndef CONCURRENT_UNION_FIND_H_
+#define CONCURRENT_UNION_FIND_H_
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Lock-free disjoint sets over the integers [0, size()). Parents are only
+// ever swung by compare-and-swap: unions link the root with the larger index
+// under the smaller one, and finds halve paths as they go. Every component is
+// therefore led by its smallest member no matter how threads interleave.
+template<class IndexType = std::uint32_t>
+class ConcurrentUnionFind
+{
+public:
+  ConcurrentUnionFind();
+
+  explicit ConcurrentUnionFind(std::size_t size);
+
+  void reset(std::size_t size);
+
+  void reset(std::size_t size, const IndexType* leaders);
+
+  std::size_t size() const;
+
+  IndexType find(IndexType vertex);
+
+  bool unionVertices(IndexType v1, IndexType v2);
+
+  bool sameSet(IndexType v1, IndexType v2);
+
+  std::vector<IndexType> flatten();
+
+private:
+  std::vector<std::atomic<IndexType>> _parent;
+};
+
+template<class IndexType>
+ConcurrentUnionFind<IndexType>::ConcurrentUnionFind()
+{
+}
+
+template<class IndexType>
+ConcurrentUnionFind<IndexType>::ConcurrentUnionFind(std::size_t size)
+{
+  reset(size);
+}
+
+template<class IndexType>
+void
+ConcurrentUnionFind<IndexType>::reset(std::size_t size)
+{
+  _parent = std::vector<std::atomic<IndexType>>(size);
+
+  for (std::size_t v = 0; v < size; v += 1) {
+    _parent[v].store(v, std::memory_order_relaxed);
+  }
+}
+
+// Restores sets from the leaders flatten() returned, each element pointing
+// straight at its leader
+template<class IndexType>
+void
+ConcurrentUnionFind<IndexType>::reset(std::size_t size,
+                                      const IndexType* leaders)
+{
+  _parent = std::vector<std::atomic<IndexType>>(size);
+
+  for (std::size_t v = 0; v < size; v += 1) {
+    _parent[v].store(leaders[v], std::memory_order_relaxed);
+  }
+}
+
+template<class IndexType>
+std::size_t
+ConcurrentUnionFind<IndexType>::size() const
+{
+  return _parent.size();
+}
+
+template<class IndexType>
+IndexType
+ConcurrentUnionFind<IndexType>::find(IndexType vertex)
+{
+  while (true) {
+    auto parent = _parent[vertex].load(std::memory_order_relaxed);
+
+    if (parent == vertex) {
+      return vertex;
+    }
+
+    auto grandparent = _parent[parent].load(std::memory_order_relaxed);
+
+    if (parent != grandparent) {
+      _parent[vertex].compare_exchange_weak(
+        parent, grandparent, std::memory_order_relaxed);
+    }
+
+    vertex = grandparent;
+  }
+}
+
+template<class IndexType>
+bool
+ConcurrentUnionFind<IndexType>::unionVertices(IndexType v1, IndexType v2)
+{
+  while (true) {
+    v1 = find(v1);
+    v2 = find(v2);
+
+    if (v1 == v2) {
+      return false;
+    }
+
+    if (v1 < v2) {
+      std::swap(v1, v2);
+    }
+
+    // v1 may have stopped being a root since find(); then retry
+    auto expected = v1;
+    if (_parent[v1].compare_exchange_strong(
+          expected, v2, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+template<class IndexType>
+bool
+ConcurrentUnionFind<IndexType>::sameSet(IndexType v1, IndexType v2)
+{
+  while (true) {
+    v1 = find(v1);
+    v2 = find(v2);
+
+    if (v1 == v2) {
+      return true;
+    }
+
+    // v1 is still a root, so the sets really were distinct at this point
+    if (_parent[v1].load(std::memory_order_relaxed) == v1) {
+      return false;
+    }
+  }
+}
+
+template<class IndexType>
+std::vector<IndexType>
+ConcurrentUnionFind<IndexType>::flatten()
+{
+  std::vector<IndexType> labels(_parent.size());
+
+  for (std::size_t v = 0; v < _parent.size(); v += 1) {
+    labels[v] = find(v);
+  }
+
+  return labels;
+}
+
+#endif // ConcurrentUnionFind.h included
@@ -0,0 +1,352 @@
+#ifndef CSR_GRAPH_H_
+#define CSR_GRAPH_H_
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BreadthFirstSearch.h"
+#include "ShortestPaths.h"
+
+// Immutable compressed sparse row form of a Graph. Vertices are numbered in
+// ascending order whatever the order of the source adjacency lists, and the
+// out-edges of vertex i are _targets/_weights[_offsets[i], _offsets[i + 1]),
+// sorted by target.
+template<class VertexType>
+class CsrGraph
+{
+public:
+  using Index = std::uint32_t;
+
+  static constexpr Index NoVertex = UINT32_MAX;
+
+  CsrGraph();
+
+  template<class AdjacencyLists>
+  explicit CsrGraph(const AdjacencyLists& adjacencyLists);
+
+  Index size() const;
+
+  std::size_t edges() const;
+
+  Index indexOf(const VertexType& v) const;
+
+  const VertexType& vertex(Index v) const;
+
+  std::size_t degree(Index v) const;
+
+  bool hasEdge(Index from, Index to) const;
+
+  int weight(Index from, Index to) const;
+
+  int maxWeight() const;
+
+  const std::vector<std::size_t>& offsets() const;
+
+  const std::vector<Index>& targets() const;
+
+  const std::vector<int>& weights() const;
+
+  template<class Fn>
+  void forEachNeighbor(Index v, Fn fn) const;
+
+  template<class Fn>
+  void forEachEdge(Fn fn) const;
+
+  void indexReverse();
+
+  bool hasReverseIndex() const;
+
+  template<class Fn>
+  void forEachInNeighbor(Index v, Fn fn) const;
+
+  std::vector<Index> bfs(Index source) const;
+
+  std::vector<int> djikstraKey(Index source) const;
+
+private:
+  std::vector<VertexType> _vertices;
+
+  std::vector<std::size_t> _offsets;
+
+  std::vector<Index> _targets;
+
+  std::vector<int> _weights;
+
+  std::vector<std::size_t> _reverseOffsets;
+
+  std::vector<Index> _sources;
+
+  std::vector<int> _reverseWeights;
+
+  int _maxWeight = 0;
+};
+
+template<class VertexType>
+CsrGraph<VertexType>::CsrGraph()
+  : _offsets(1, 0)
+{
+}
+
+template<class VertexType>
+template<class AdjacencyLists>
+CsrGraph<VertexType>::CsrGraph(const AdjacencyLists& adjacencyLists)
+{
+  std::size_t edgeCount = 0;
+
+  _vertices.reserve(adjacencyLists.size());
+  for (auto& sourceVertex : adjacencyLists) {
+    _vertices.push_back(sourceVertex.first);
+    edgeCount += sourceVertex.second.size();
+  }
+
+  if (!std::is_sorted(_vertices.begin(), _vertices.end())) {
+    std::sort(_vertices.begin(), _vertices.end());
+  }
+
+  // edges may point at vertices that were never added as sources
+  std::vector<VertexType> missing;
+  for (auto& sourceVertex : adjacencyLists) {
+    for (auto& destVertex : sourceVertex.second) {
+      if (indexOf(destVertex.first) == NoVertex) {
+        missing.push_back(destVertex.first);
+      }
+    }
+  }
+
+  if (!missing.empty()) {
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    auto middle = _vertices.size();
+    _vertices.insert(_vertices.end(), missing.begin(), missing.end());
+    std::inplace_merge(
+      _vertices.begin(), _vertices.begin() + middle, _vertices.end());
+  }
+
+  _offsets.assign(_vertices.size() + 1, 0);
+  _targets.reserve(edgeCount);
+  _weights.reserve(edgeCount);
+
+  std::vector<std::pair<Index, int>> row;
+
+  for (Index v = 0; v < _vertices.size(); v += 1) {
+    auto found = adjacencyLists.find(_vertices[v]);
+
+    if (found != adjacencyLists.end()) {
+      row.clear();
+      for (auto& destVertex : found->second) {
+        row.push_back({ indexOf(destVertex.first), destVertex.second });
+      }
+
+      // hashed lists come out in no particular order
+      if (!std::is_sorted(row.begin(), row.end())) {
+        std::sort(row.begin(), row.end());
+      }
+
+      for (auto& edge : row) {
+        _targets.push_back(edge.first);
+        _weights.push_back(edge.second);
+        _maxWeight = std::max(_maxWeight, edge.second);
+      }
+    }
+
+    _offsets[v + 1] = _targets.size();
+  }
+}
+
+template<class VertexType>
+typename CsrGraph<VertexType>::Index
+CsrGraph<VertexType>::size() const
+{
+  return _vertices.size();
+}
+
+template<class VertexType>
+std::size_t
+CsrGraph<VertexType>::edges() const
+{
+  return _targets.size();
+}
+
+template<class VertexType>
+typename CsrGraph<VertexType>::Index
+CsrGraph<VertexType>::indexOf(const VertexType& v) const
+{
+  auto it = std::lower_bound(_vertices.begin(), _vertices.end(), v);
+
+  if (it == _vertices.end() || v < *it) {
+    return NoVertex;
+  }
+
+  return it - _vertices.begin();
+}
+
+template<class VertexType>
+const VertexType&
+CsrGraph<VertexType>::vertex(Index v) const
+{
+  return _vertices[v];
+}
+
+template<class VertexType>
+std::size_t
+CsrGraph<VertexType>::degree(Index v) const
+{
+  return _offsets[v + 1] - _offsets[v];
+}
+
+template<class VertexType>
+bool
+CsrGraph<VertexType>::hasEdge(Index from, Index to) const
+{
+  auto begin = _targets.begin() + _offsets[from];
+  auto end = _targets.begin() + _offsets[from + 1];
+
+  return std::binary_search(begin, end, to);
+}
+
+template<class VertexType>
+int
+CsrGraph<VertexType>::weight(Index from, Index to) const
+{
+  auto begin = _targets.begin() + _offsets[from];
+  auto end = _targets.begin() + _offsets[from + 1];
+  auto it = std::lower_bound(begin, end, to);
+
+  if (it == end || *it != to) {
+    return 0;
+  }
+
+  return _weights[it - _targets.begin()];
+}
+
+template<class VertexType>
+int
+CsrGraph<VertexType>::maxWeight() const
+{
+  return _maxWeight;
+}
+
+template<class VertexType>
+const std::vector<std::size_t>&
+CsrGraph<VertexType>::offsets() const
+{
+  return _offsets;
+}
+
+template<class VertexType>
+const std::vector<typename CsrGraph<VertexType>::Index>&
+CsrGraph<VertexType>::targets() const
+{
+  return _targets;
+}
+
+template<class VertexType>
+const std::vector<int>&
+CsrGraph<VertexType>::weights() const
+{
+  return _weights;
+}
+
+template<class VertexType>
+template<class Fn>
+void
+CsrGraph<VertexType>::forEachNeighbor(Index v, Fn fn) const
+{
+  for (auto e = _offsets[v]; e < _offsets[v + 1]; e += 1) {
+    fn(_targets[e], _weights[e]);
+  }
+}
+
+template<class VertexType>
+template<class Fn>
+void
+CsrGraph<VertexType>::forEachEdge(Fn fn) const
+{
+  for (Index v = 0; v < size(); v += 1) {
+    for (auto e = _offsets[v]; e < _offsets[v + 1]; e += 1) {
+      fn(v, _targets[e], _weights[e]);
+    }
+  }
+}
+
+// Builds the in-edges of every vertex, sorted by source, in the same CSR
+// layout; until then forEachInNeighbor sees no edges. Its fn may return
+// bool, and false stops the walk.
+template<class VertexType>
+void
+CsrGraph<VertexType>::indexReverse()
+{
+  _reverseOffsets.assign(size() + 1, 0);
+  _sources.resize(edges());
+  _reverseWeights.resize(edges());
+
+  for (auto to : _targets) {
+    _reverseOffsets[to + 1] += 1;
+  }
+
+  for (Index v = 0; v < size(); v += 1) {
+    _reverseOffsets[v + 1] += _reverseOffsets[v];
+  }
+
+  auto next = _reverseOffsets;
+  forEachEdge([&](Index from, Index to, int weight) {
+    _sources[next[to]] = from;
+    _reverseWeights[next[to]] = weight;
+    next[to] += 1;
+  });
+}
+
+template<class VertexType>
+bool
+CsrGraph<VertexType>::hasReverseIndex() const
+{
+  return !_reverseOffsets.empty();
+}
+
+template<class VertexType>
+template<class Fn>
+void
+CsrGraph<VertexType>::forEachInNeighbor(Index v, Fn fn) const
+{
+  if (_reverseOffsets.empty()) {
+    return;
+  }
+
+  for (auto e = _reverseOffsets[v]; e < _reverseOffsets[v + 1]; e += 1) {
+    if constexpr (std::is_same<decltype(fn(_sources[e], _reverseWeights[e])),
+                               bool>::value) {
+      if (!fn(_sources[e], _reverseWeights[e])) {
+        return;
+      }
+    } else {
+      fn(_sources[e], _reverseWeights[e]);
+    }
+  }
+}
+
+template<class VertexType>
+std::vector<typename CsrGraph<VertexType>::Index>
+CsrGraph<VertexType>::bfs(Index source) const
+{
+  BreadthFirstSearch<CsrGraph<VertexType>> search(*this);
+  search.run(source);
+
+  return search.takeOrder();
+}
+
+template<class VertexType>
+std::vector<int>
+CsrGraph<VertexType>::djikstraKey(Index source) const
+{
+  ShortestPaths<CsrGraph<VertexType>> paths(*this);
+  paths.run(source);
+
+  return paths.takeDistances();
+}
+
+#endif // CsrGraph.h included
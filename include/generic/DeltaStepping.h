@@ -0,0 +1,236 @@
+#ifndef DELTA_STEPPING_H_
+#define DELTA_STEPPING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "../util/Parallel.h"
+
+// Parallel single-source shortest paths by delta-stepping (Meyer & Sanders).
+// Vertices are kept in buckets of width delta; the current bucket is emptied
+// by repeated parallel relaxation of its light edges (weight <= delta), then
+// heavy edges of everything it held are relaxed once. Each worker appends to
+// its own bucket lists and distances are lowered with compare-and-swap, so
+// the result equals the serial ShortestPaths distances.
+template<class GraphType>
+class DeltaStepping
+{
+public:
+  using Index = std::uint32_t;
+
+  static constexpr int Unreachable = INT_MAX;
+
+  DeltaStepping(const GraphType& graph, WorkerPool& pool, int delta = 0);
+
+  void run(Index source);
+
+  const std::vector<int>& distances() const;
+
+  std::vector<int> takeDistances();
+
+private:
+  void push(int worker, Index vertex, int distance);
+
+  void relax(int worker, Index from, bool light);
+
+  bool gather(std::size_t bucket);
+
+  std::size_t nextBucket(std::size_t bucket) const;
+
+  const GraphType& _graph;
+
+  WorkerPool& _pool;
+
+  int _delta;
+
+  std::vector<std::atomic<int>> _tentative;
+
+  std::vector<std::vector<std::vector<Index>>> _buckets;
+
+  std::vector<std::vector<Index>> _settled;
+
+  std::vector<Index> _frontier;
+
+  std::vector<int> _distances;
+};
+
+template<class GraphType>
+DeltaStepping<GraphType>::DeltaStepping(const GraphType& graph,
+                                        WorkerPool& pool,
+                                        int delta)
+  : _graph(graph)
+  , _pool(pool)
+  , _delta(delta)
+{
+  if (_delta <= 0) {
+    _delta = std::max(1, (static_cast<int>(_graph.maxWeight()) + 1) / 2);
+  }
+}
+
+template<class GraphType>
+void
+DeltaStepping<GraphType>::run(Index source)
+{
+  _tentative = std::vector<std::atomic<int>>(_graph.size());
+  _buckets.assign(_pool.size(), {});
+  _settled.assign(_pool.size(), {});
+  _distances.clear();
+
+  _pool.parallelFor(
+    _graph.size(), [&](int, std::size_t begin, std::size_t end) {
+      for (auto v = begin; v < end; v += 1) {
+        _tentative[v].store(Unreachable, std::memory_order_relaxed);
+      }
+    });
+
+  if (source < _graph.size()) {
+    _tentative[source].store(0, std::memory_order_relaxed);
+    push(0, source, 0);
+  }
+
+  for (auto bucket = nextBucket(0); bucket != SIZE_MAX;
+       bucket = nextBucket(bucket + 1)) {
+    for (auto& settled : _settled) {
+      settled.clear();
+    }
+
+    // light edges can refill the current bucket, so repeat until it stays
+    // empty; every vertex taken out of it is remembered for the heavy pass
+    while (gather(bucket)) {
+      _pool.parallelFor(
+        _frontier.size(), [&](int worker, std::size_t begin, std::size_t end) {
+          for (auto i = begin; i < end; i += 1) {
+            auto v = _frontier[i];
+            auto d = _tentative[v].load(std::memory_order_relaxed);
+
+            if (static_cast<std::size_t>(d / _delta) != bucket) {
+              continue;
+            }
+
+            _settled[worker].push_back(v);
+            relax(worker, v, true);
+          }
+        });
+    }
+
+    for (auto& buckets : _buckets) {
+      if (bucket < buckets.size()) {
+        std::vector<Index>().swap(buckets[bucket]);
+      }
+    }
+
+    _frontier.clear();
+    for (auto& settled : _settled) {
+      _frontier.insert(_frontier.end(), settled.begin(), settled.end());
+    }
+
+    _pool.parallelFor(
+      _frontier.size(), [&](int worker, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i += 1) {
+          relax(worker, _frontier[i], false);
+        }
+      });
+  }
+
+  _distances.resize(_graph.size());
+  _pool.parallelFor(
+    _graph.size(), [&](int, std::size_t begin, std::size_t end) {
+      for (auto v = begin; v < end; v += 1) {
+        _distances[v] = _tentative[v].load(std::memory_order_relaxed);
+      }
+    });
+
+  _tentative = std::vector<std::atomic<int>>();
+}
+
+template<class GraphType>
+const std::vector<int>&
+DeltaStepping<GraphType>::distances() const
+{
+  return _distances;
+}
+
+template<class GraphType>
+std::vector<int>
+DeltaStepping<GraphType>::takeDistances()
+{
+  return std::move(_distances);
+}
+
+template<class GraphType>
+void
+DeltaStepping<GraphType>::push(int worker, Index vertex, int distance)
+{
+  auto& buckets = _buckets[worker];
+  std::size_t bucket = distance / _delta;
+
+  if (buckets.size() <= bucket) {
+    buckets.resize(bucket + 1);
+  }
+
+  buckets[bucket].push_back(vertex);
+}
+
+template<class GraphType>
+void
+DeltaStepping<GraphType>::relax(int worker, Index from, bool light)
+{
+  auto d = _tentative[from].load(std::memory_order_relaxed);
+
+  _graph.forEachNeighbor(from, [&](Index to, int w) {
+    if ((w <= _delta) != light) {
+      return;
+    }
+
+    auto candidate = d + w;
+    auto current = _tentative[to].load(std::memory_order_relaxed);
+
+    while (candidate < current) {
+      if (_tentative[to].compare_exchange_weak(
+            current, candidate, std::memory_order_relaxed)) {
+        push(worker, to, candidate);
+        break;
+      }
+    }
+  });
+}
+
+template<class GraphType>
+bool
+DeltaStepping<GraphType>::gather(std::size_t bucket)
+{
+  _frontier.clear();
+
+  for (auto& buckets : _buckets) {
+    if (bucket < buckets.size()) {
+      _frontier.insert(
+        _frontier.end(), buckets[bucket].begin(), buckets[bucket].end());
+      buckets[bucket].clear();
+    }
+  }
+
+  return !_frontier.empty();
+}
+
+template<class GraphType>
+std::size_t
+DeltaStepping<GraphType>::nextBucket(std::size_t bucket) const
+{
+  auto next = SIZE_MAX;
+
+  for (auto& buckets : _buckets) {
+    for (auto b = bucket; b < buckets.size() && b < next; b += 1) {
+      if (!buckets[b].empty()) {
+        next = b;
+        break;
+      }
+    }
+  }
+
+  return next;
+}
+
+#endif // DeltaStepping.h included
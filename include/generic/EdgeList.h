@@ -0,0 +1,66 @@
+#ifndef EDGE_LIST_H_
+#define EDGE_LIST_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../util/Parallel.h"
+
+struct WeightedEdge
+{
+  std::uint32_t from;
+  std::uint32_t to;
+  int weight;
+};
+
+// The edges of any index graph that provides size(), hasEdge(from, to),
+// weight(from, to) and forEachNeighbor(v, fn(to, weight)) as undirected
+// edges with from < to. A pair linked both ways is listed once, with the
+// smaller of its two weights. Edges are listed in order of the vertex they
+// were found from, whatever the number of workers.
+template<class GraphType>
+std::vector<WeightedEdge>
+undirectedEdges(const GraphType& graph, WorkerPool& pool)
+{
+  using Index = std::uint32_t;
+
+  std::vector<std::vector<WeightedEdge>> parts(pool.size());
+
+  pool.parallelFor(
+    graph.size(), [&](int worker, std::size_t begin, std::size_t end) {
+      auto& part = parts[worker];
+
+      for (Index v = begin; v < end; v += 1) {
+        graph.forEachNeighbor(v, [&](Index to, auto w) {
+          int weight = w;
+
+          if (to > v) {
+            if (graph.hasEdge(to, v)) {
+              weight = std::min<int>(weight, graph.weight(to, v));
+            }
+            part.push_back({ v, to, weight });
+          } else if (to < v && !graph.hasEdge(to, v)) {
+            part.push_back({ to, v, weight });
+          }
+        });
+      }
+    });
+
+  std::size_t count = 0;
+  for (auto& part : parts) {
+    count += part.size();
+  }
+
+  std::vector<WeightedEdge> edges;
+  edges.reserve(count);
+
+  for (auto& part : parts) {
+    edges.insert(edges.end(), part.begin(), part.end());
+    std::vector<WeightedEdge>().swap(part);
+  }
+
+  return edges;
+}
+
+#endif // EdgeList.h included
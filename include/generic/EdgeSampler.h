@@ -0,0 +1,259 @@
+#ifndef EDGE_SAMPLER_H_
+#define EDGE_SAMPLER_H_
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Graph.h"
+
+// Random edges of a Graph in O(1) per draw: uniformly from a flat copy of
+// the edge list, or in proportion to weight through Vose's alias table
+// (edges weighing zero or less are never drawn by weight, and a graph with
+// no positive weight is sampled uniformly). The sampler is a snapshot; it
+// remembers the graph's version, and stale() tells when the graph has
+// changed since the last rebuild(). An empty sampler draws a
+// value-initialized edge, and the batch draws leave out empty.
+template<class VertexType>
+class EdgeSampler
+{
+public:
+  struct Edge
+  {
+    VertexType from;
+    VertexType to;
+    int weight;
+  };
+
+  EdgeSampler();
+
+  template<class Storage>
+  explicit EdgeSampler(const Graph<VertexType, Storage>& graph);
+
+  template<class Storage>
+  void rebuild(const Graph<VertexType, Storage>& graph);
+
+  template<class Storage>
+  bool stale(const Graph<VertexType, Storage>& graph) const;
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  long long totalWeight() const;
+
+  const std::vector<Edge>& edges() const;
+
+  template<class Random>
+  const Edge& uniform(Random& random) const;
+
+  template<class Random>
+  const Edge& weighted(Random& random) const;
+
+  template<class Random>
+  void uniform(std::size_t count, Random& random, std::vector<Edge>& out) const;
+
+  template<class Random>
+  void weighted(std::size_t count,
+                Random& random,
+                std::vector<Edge>& out) const;
+
+private:
+  std::vector<Edge> _edges;
+
+  std::vector<double> _threshold;
+
+  std::vector<std::uint32_t> _alias;
+
+  long long _totalWeight = 0;
+
+  std::uint64_t _version = 0;
+
+  Edge _none = {};
+};
+
+template<class VertexType>
+EdgeSampler<VertexType>::EdgeSampler()
+{
+}
+
+template<class VertexType>
+template<class Storage>
+EdgeSampler<VertexType>::EdgeSampler(const Graph<VertexType, Storage>& graph)
+{
+  rebuild(graph);
+}
+
+template<class VertexType>
+template<class Storage>
+void
+EdgeSampler<VertexType>::rebuild(const Graph<VertexType, Storage>& graph)
+{
+  _edges.clear();
+  _totalWeight = 0;
+  _version = graph.version();
+
+  graph.forEachEdge(
+    [&](const VertexType& from, const VertexType& to, int weight) {
+      _edges.push_back({ from, to, weight });
+      _totalWeight += weight > 0 ? weight : 0;
+    });
+
+  std::size_t size = _edges.size();
+  _threshold.assign(size, 1.);
+  _alias.resize(size);
+
+  if (_totalWeight == 0) {
+    return;
+  }
+
+  // scale weights to a mean of 1, then pair each column below 1 with one
+  // above it that tops it up
+  std::vector<std::uint32_t> small;
+  std::vector<std::uint32_t> large;
+
+  for (std::uint32_t e = 0; e < size; e += 1) {
+    auto weight = _edges[e].weight > 0 ? _edges[e].weight : 0;
+    _threshold[e] = static_cast<double>(weight) * size / _totalWeight;
+    _alias[e] = e;
+
+    if (_threshold[e] < 1.) {
+      small.push_back(e);
+    } else {
+      large.push_back(e);
+    }
+  }
+
+  while (!small.empty() && !large.empty()) {
+    auto less = small.back();
+    auto more = large.back();
+    small.pop_back();
+
+    _alias[less] = more;
+    _threshold[more] -= 1. - _threshold[less];
+
+    if (_threshold[more] < 1.) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+
+  // whatever is left is 1 up to rounding
+  for (auto e : small) {
+    _threshold[e] = 1.;
+  }
+  for (auto e : large) {
+    _threshold[e] = 1.;
+  }
+}
+
+template<class VertexType>
+template<class Storage>
+bool
+EdgeSampler<VertexType>::stale(const Graph<VertexType, Storage>& graph) const
+{
+  return graph.version() != _version;
+}
+
+template<class VertexType>
+std::size_t
+EdgeSampler<VertexType>::size() const
+{
+  return _edges.size();
+}
+
+template<class VertexType>
+bool
+EdgeSampler<VertexType>::empty() const
+{
+  return _edges.empty();
+}
+
+template<class VertexType>
+long long
+EdgeSampler<VertexType>::totalWeight() const
+{
+  return _totalWeight;
+}
+
+template<class VertexType>
+const std::vector<typename EdgeSampler<VertexType>::Edge>&
+EdgeSampler<VertexType>::edges() const
+{
+  return _edges;
+}
+
+template<class VertexType>
+template<class Random>
+const typename EdgeSampler<VertexType>::Edge&
+EdgeSampler<VertexType>::uniform(Random& random) const
+{
+  if (_edges.empty()) {
+    return _none;
+  }
+
+  std::uniform_int_distribution<std::size_t> column(0, _edges.size() - 1);
+
+  return _edges[column(random)];
+}
+
+template<class VertexType>
+template<class Random>
+const typename EdgeSampler<VertexType>::Edge&
+EdgeSampler<VertexType>::weighted(Random& random) const
+{
+  if (_edges.empty()) {
+    return _none;
+  }
+
+  std::uniform_int_distribution<std::size_t> column(0, _edges.size() - 1);
+  std::uniform_real_distribution<double> coin(0., 1.);
+
+  auto e = column(random);
+
+  return _edges[coin(random) < _threshold[e] ? e : _alias[e]];
+}
+
+template<class VertexType>
+template<class Random>
+void
+EdgeSampler<VertexType>::uniform(std::size_t count,
+                                 Random& random,
+                                 std::vector<Edge>& out) const
+{
+  if (_edges.empty()) {
+    out.clear();
+    return;
+  }
+
+  std::uniform_int_distribution<std::size_t> column(0, _edges.size() - 1);
+
+  out.resize(count);
+  for (auto& edge : out) {
+    edge = _edges[column(random)];
+  }
+}
+
+template<class VertexType>
+template<class Random>
+void
+EdgeSampler<VertexType>::weighted(std::size_t count,
+                                  Random& random,
+                                  std::vector<Edge>& out) const
+{
+  if (_edges.empty()) {
+    out.clear();
+    return;
+  }
+
+  std::uniform_int_distribution<std::size_t> column(0, _edges.size() - 1);
+  std::uniform_real_distribution<double> coin(0., 1.);
+
+  out.resize(count);
+  for (auto& edge : out) {
+    auto e = column(random);
+    edge = _edges[coin(random) < _threshold[e] ? e : _alias[e]];
+  }
+}
+
+#endif // EdgeSampler.h included
@@ -0,0 +1,405 @@
+#ifndef FLAT_HASH_MAP_H_
+#define FLAT_HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// An open addressing hash map with linear probing over one flat array of
+// key/value pairs, kept at most three quarters full. Erasing shifts the
+// following run of the probe sequence back, so there are no tombstones.
+// Covers the std::map operations the graph code uses; inserting may move
+// every element, so references are only stable until the next insertion.
+template<class KeyType, class ValueType, class Hash = std::hash<KeyType>>
+class FlatHashMap
+{
+public:
+  using value_type = std::pair<KeyType, ValueType>;
+
+  template<class MapType, class Value>
+  class SlotIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+
+    using value_type = std::pair<KeyType, ValueType>;
+
+    using difference_type = std::ptrdiff_t;
+
+    using pointer = Value*;
+
+    using reference = Value&;
+
+    SlotIterator(MapType* map, std::size_t slot);
+
+    reference operator*() const;
+
+    pointer operator->() const;
+
+    SlotIterator& operator++();
+
+    SlotIterator operator++(int);
+
+    bool operator==(const SlotIterator& other) const;
+
+    bool operator!=(const SlotIterator& other) const;
+
+  private:
+    friend class FlatHashMap;
+
+    void skipEmpty();
+
+    MapType* _map;
+
+    std::size_t _slot;
+  };
+
+  using iterator = SlotIterator<FlatHashMap, value_type>;
+
+  using const_iterator = SlotIterator<const FlatHashMap, const value_type>;
+
+  FlatHashMap();
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  void clear();
+
+  void reserve(std::size_t count);
+
+  iterator begin();
+
+  iterator end();
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  iterator find(const KeyType& key);
+
+  const_iterator find(const KeyType& key) const;
+
+  std::pair<iterator, bool> insert(const value_type& value);
+
+  ValueType& operator[](const KeyType& key);
+
+  std::size_t erase(const KeyType& key);
+
+private:
+  std::size_t home(const KeyType& key) const;
+
+  std::size_t locate(const KeyType& key) const;
+
+  void rehash(std::size_t capacity);
+
+  std::vector<value_type> _slots;
+
+  std::vector<std::uint8_t> _used;
+
+  std::size_t _size = 0;
+};
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+  SlotIterator(MapType* map, std::size_t slot)
+  : _map(map)
+  , _slot(slot)
+{
+  skipEmpty();
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+Value&
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator*() const
+{
+  return _map->_slots[_slot];
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+Value*
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator->() const
+{
+  return &_map->_slots[_slot];
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+typename FlatHashMap<KeyType, ValueType, Hash>::template SlotIterator<MapType,
+                                                                      Value>&
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator++()
+{
+  _slot += 1;
+  skipEmpty();
+
+  return *this;
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+typename FlatHashMap<KeyType, ValueType, Hash>::template SlotIterator<MapType,
+                                                                      Value>
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator++(int)
+{
+  auto previous = *this;
+  ++*this;
+
+  return previous;
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+bool
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator==(const SlotIterator& other) const
+{
+  return _slot == other._slot;
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+bool
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType, Value>::
+operator!=(const SlotIterator& other) const
+{
+  return _slot != other._slot;
+}
+
+template<class KeyType, class ValueType, class Hash>
+template<class MapType, class Value>
+void
+FlatHashMap<KeyType, ValueType, Hash>::SlotIterator<MapType,
+                                                    Value>::skipEmpty()
+{
+  while (_slot < _map->_used.size() && !_map->_used[_slot]) {
+    _slot += 1;
+  }
+}
+
+template<class KeyType, class ValueType, class Hash>
+FlatHashMap<KeyType, ValueType, Hash>::FlatHashMap()
+{
+}
+
+template<class KeyType, class ValueType, class Hash>
+std::size_t
+FlatHashMap<KeyType, ValueType, Hash>::size() const
+{
+  return _size;
+}
+
+template<class KeyType, class ValueType, class Hash>
+bool
+FlatHashMap<KeyType, ValueType, Hash>::empty() const
+{
+  return _size == 0;
+}
+
+template<class KeyType, class ValueType, class Hash>
+void
+FlatHashMap<KeyType, ValueType, Hash>::clear()
+{
+  _slots.clear();
+  _used.clear();
+  _size = 0;
+}
+
+template<class KeyType, class ValueType, class Hash>
+void
+FlatHashMap<KeyType, ValueType, Hash>::reserve(std::size_t count)
+{
+  std::size_t capacity = 8;
+
+  while (capacity * 3 < count * 4) {
+    capacity *= 2;
+  }
+
+  if (capacity > _slots.size()) {
+    rehash(capacity);
+  }
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::iterator
+FlatHashMap<KeyType, ValueType, Hash>::begin()
+{
+  return iterator(this, 0);
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::iterator
+FlatHashMap<KeyType, ValueType, Hash>::end()
+{
+  return iterator(this, _slots.size());
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::const_iterator
+FlatHashMap<KeyType, ValueType, Hash>::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::const_iterator
+FlatHashMap<KeyType, ValueType, Hash>::end() const
+{
+  return const_iterator(this, _slots.size());
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::iterator
+FlatHashMap<KeyType, ValueType, Hash>::find(const KeyType& key)
+{
+  auto slot = locate(key);
+
+  if (slot == _slots.size() || !_used[slot]) {
+    return end();
+  }
+
+  return iterator(this, slot);
+}
+
+template<class KeyType, class ValueType, class Hash>
+typename FlatHashMap<KeyType, ValueType, Hash>::const_iterator
+FlatHashMap<KeyType, ValueType, Hash>::find(const KeyType& key) const
+{
+  auto slot = locate(key);
+
+  if (slot == _slots.size() || !_used[slot]) {
+    return end();
+  }
+
+  return const_iterator(this, slot);
+}
+
+template<class KeyType, class ValueType, class Hash>
+std::pair<typename FlatHashMap<KeyType, ValueType, Hash>::iterator, bool>
+FlatHashMap<KeyType, ValueType, Hash>::insert(const value_type& value)
+{
+  if ((_size + 1) * 4 > _slots.size() * 3) {
+    rehash(_slots.empty() ? 8 : _slots.size() * 2);
+  }
+
+  auto slot = locate(value.first);
+
+  if (_used[slot]) {
+    return { iterator(this, slot), false };
+  }
+
+  _slots[slot] = value;
+  _used[slot] = 1;
+  _size += 1;
+
+  return { iterator(this, slot), true };
+}
+
+template<class KeyType, class ValueType, class Hash>
+ValueType&
+FlatHashMap<KeyType, ValueType, Hash>::operator[](const KeyType& key)
+{
+  auto found = find(key);
+
+  if (found != end()) {
+    return found->second;
+  }
+
+  return insert({ key, ValueType() }).first->second;
+}
+
+template<class KeyType, class ValueType, class Hash>
+std::size_t
+FlatHashMap<KeyType, ValueType, Hash>::erase(const KeyType& key)
+{
+  auto hole = locate(key);
+
+  if (hole == _slots.size() || !_used[hole]) {
+    return 0;
+  }
+
+  // pull back every later entry of the run whose home is not between the
+  // hole and its own slot, so lookups never stop at the hole too early
+  auto mask = _slots.size() - 1;
+
+  for (auto slot = (hole + 1) & mask; _used[slot]; slot = (slot + 1) & mask) {
+    auto wanted = home(_slots[slot].first);
+    bool stays = hole <= slot ? (hole < wanted && wanted <= slot)
+                              : (hole < wanted || wanted <= slot);
+
+    if (!stays) {
+      _slots[hole] = std::move(_slots[slot]);
+      hole = slot;
+    }
+  }
+
+  _slots[hole] = value_type();
+  _used[hole] = 0;
+  _size -= 1;
+
+  return 1;
+}
+
+template<class KeyType, class ValueType, class Hash>
+std::size_t
+FlatHashMap<KeyType, ValueType, Hash>::home(const KeyType& key) const
+{
+  // std::hash of an integer is often the integer itself; mix the bits so
+  // runs of keys do not pile up in the same probe sequence
+  std::uint64_t h = Hash()(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+
+  return h & (_slots.size() - 1);
+}
+
+// the slot holding key, else the empty slot where it would go; size() when
+// the table has no slots
+template<class KeyType, class ValueType, class Hash>
+std::size_t
+FlatHashMap<KeyType, ValueType, Hash>::locate(const KeyType& key) const
+{
+  if (_slots.empty()) {
+    return 0;
+  }
+
+  auto mask = _slots.size() - 1;
+  auto slot = home(key);
+
+  while (_used[slot] && !(_slots[slot].first == key)) {
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+template<class KeyType, class ValueType, class Hash>
+void
+FlatHashMap<KeyType, ValueType, Hash>::rehash(std::size_t capacity)
+{
+  std::vector<value_type> slots(capacity);
+  std::vector<std::uint8_t> used(capacity, 0);
+
+  _slots.swap(slots);
+  _used.swap(used);
+
+  for (std::size_t slot = 0; slot < slots.size(); slot += 1) {
+    if (used[slot]) {
+      auto target = locate(slots[slot].first);
+      _slots[target] = std::move(slots[slot]);
+      _used[target] = 1;
+    }
+  }
+}
+
+#endif // FlatHashMap.h included
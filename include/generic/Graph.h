@@ -3,20 +3,39 @@
 
 #include <climits>
 #include <cstdint>
-#include <map>
+#include <memory>
 #include <queue>
 #include <random>
+#include <type_traits>
 #include <vector>
 
+#include "CsrGraph.h"
+#include "GraphStorage.h"
 #include "Heap.h"
 
-template<class VertexType>
+// Storage picks the adjacency layout (see GraphStorage.h); the default
+// keeps the ordered maps. Copies share their lists until one of them is
+// changed, and moves never copy them.
+template<class VertexType, class Storage = OrderedStorage<VertexType>>
 class Graph
 {
 public:
+  using AdjacencyLists = typename Storage::Lists;
+
+  using Neighbors = typename Storage::Neighbors;
+
   Graph();
 
-  Graph(Graph<VertexType>& copy_from);
+  Graph(const Graph& other);
+
+  Graph(Graph&& other) noexcept;
+
+  template<class OtherStorage>
+  explicit Graph(const Graph<VertexType, OtherStorage>& other);
+
+  Graph& operator=(const Graph& other);
+
+  Graph& operator=(Graph&& other) noexcept;
 
   void clear();
 
@@ -30,17 +49,40 @@ public:
 
   void removeEdge(const VertexType& from, const VertexType& to);
 
-  bool hasEdge(const VertexType& from, const VertexType& to);
+  bool hasEdge(const VertexType& from, const VertexType& to) const;
+
+  bool hasEdges(const VertexType& from) const;
+
+  int weight(const VertexType& from, const VertexType& to) const;
+
+  AdjacencyLists& getAdjacencyLists();
+
+  const AdjacencyLists& adjacencyLists() const;
+
+  Neighbors& connectedTo(const VertexType& from);
 
-  bool hasEdges(const VertexType& from);
+  template<class Fn>
+  void forEachEdge(Fn fn) const;
 
-  int weight(const VertexType& from, const VertexType& to);
+  void indexReverse();
 
-  std::map<VertexType, std::map<VertexType, int>>& getAdjacencyLists();
+  bool hasReverseIndex() const;
 
-  std::map<VertexType, int>& connectedTo(const VertexType& from);
+  template<class Fn>
+  void forEachPredecessor(const VertexType& v, Fn fn) const;
 
-  Graph<VertexType> bfs(VertexType& sourceVertex);
+  std::vector<VertexType> predecessors(const VertexType& v) const;
+
+  std::uint64_t version() const;
+
+  template<class Visitor>
+  void bfs(const VertexType& sourceVertex, Visitor visit) const;
+
+  std::vector<VertexType> reachable(const VertexType& sourceVertex) const;
+
+  Graph<VertexType> subgraph(const std::vector<VertexType>& vertices) const;
+
+  CsrGraph<VertexType> freeze() const;
 
   void contractRandomEdgeNoParallel();
 
@@ -51,260 +93,636 @@ public:
   std::pair<VertexType, VertexType> chooseRandomEdge(VertexType& startVertex);
 
 private:
-  std::map<VertexType, std::map<VertexType, int>> _adjacencyLists;
+  struct State
+  {
+    AdjacencyLists adjacencyLists;
+
+    AdjacencyLists reverseLists;
+
+    bool reverseIndexed = false;
+
+    // false once a mutable reference to the lists has been handed out
+    bool shareable = true;
+  };
+
+  static const std::shared_ptr<State>& emptyState();
+
+  void detach();
+
+  std::shared_ptr<State> _state;
+
+  std::uint64_t _version = 0;
 };
 
-template<class VertexType>
-Graph<VertexType>::Graph()
+// An empty graph shares one empty state with every other until written to
+template<class VertexType, class Storage>
+Graph<VertexType, Storage>::Graph()
+  : _state(emptyState())
+{
+}
+
+// Copies share the lists until either side changes them; a graph whose
+// lists were handed out through getAdjacencyLists() or connectedTo() may
+// still be edited behind its back, so it is copied in full
+template<class VertexType, class Storage>
+Graph<VertexType, Storage>::Graph(const Graph& other)
+  : _state(other._state)
+  , _version(other._version)
 {
+  if (!_state->shareable) {
+    _state = std::make_shared<State>(*_state);
+    _state->shareable = true;
+  }
 }
 
-template<class VertexType>
-Graph<VertexType>::Graph(Graph<VertexType>& copy_from)
+template<class VertexType, class Storage>
+Graph<VertexType, Storage>::Graph(Graph&& other) noexcept
+  : _state(std::move(other._state))
+  , _version(other._version)
 {
-  _adjacencyLists.clear();
+  other._state = emptyState();
+  other._version += 1;
+}
+
+// Copies a graph held in another layout; frozen storage is built in one go
+// from the source lists, any other layout edge by edge
+template<class VertexType, class Storage>
+template<class OtherStorage>
+Graph<VertexType, Storage>::Graph(const Graph<VertexType, OtherStorage>& other)
+  : _state(std::make_shared<State>())
+{
+  using OtherLists = typename Graph<VertexType, OtherStorage>::AdjacencyLists;
+
+  if constexpr (std::is_constructible<AdjacencyLists,
+                                      const OtherLists&>::value) {
+    _state->adjacencyLists = AdjacencyLists(other.adjacencyLists());
+  } else {
+    for (auto& sourceVertex : other.adjacencyLists()) {
+      auto& edges = _state->adjacencyLists[sourceVertex.first];
 
-  for (auto& elem : copy_from.getAdjacencyLists()) {
-    addVertex(elem.first);
-    for (auto& destVertex : elem.second) {
-      addNewEdge(elem.first, destVertex.first, destVertex.second);
+      for (auto& destVertex : sourceVertex.second) {
+        edges.insert({ destVertex.first, destVertex.second });
+      }
+    }
+  }
+}
+
+template<class VertexType, class Storage>
+Graph<VertexType, Storage>&
+Graph<VertexType, Storage>::operator=(const Graph& other)
+{
+  if (this != &other) {
+    _state = other._state;
+    _version += 1;
+
+    if (!_state->shareable) {
+      _state = std::make_shared<State>(*_state);
+      _state->shareable = true;
     }
   }
+
+  return *this;
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
+Graph<VertexType, Storage>&
+Graph<VertexType, Storage>::operator=(Graph&& other) noexcept
+{
+  if (this != &other) {
+    _state = std::move(other._state);
+    other._state = emptyState();
+    _version += 1;
+    other._version += 1;
+  }
+
+  return *this;
+}
+
+template<class VertexType, class Storage>
+const std::shared_ptr<typename Graph<VertexType, Storage>::State>&
+Graph<VertexType, Storage>::emptyState()
+{
+  static const auto empty = std::make_shared<State>();
+
+  return empty;
+}
+
+// Gives this graph its own copy of shared lists before a write. The empty
+// state is always held by emptyState() too, so it is never written to.
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::clear()
+Graph<VertexType, Storage>::detach()
 {
-  _adjacencyLists.clear();
+  if (_state.use_count() > 1) {
+    _state = std::make_shared<State>(*_state);
+    _state->shareable = true;
+  }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::addVertex(const VertexType& v)
+Graph<VertexType, Storage>::clear()
 {
-  _adjacencyLists.insert({ v, std::map<VertexType, int>() });
+  _version += 1;
+
+  // drops this graph's hold on the lists instead of copying them to empty
+  auto indexed = _state->reverseIndexed;
+  _state = emptyState();
+
+  if (indexed) {
+    detach();
+    _state->reverseIndexed = true;
+  }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::removeVertex(const VertexType& v)
+Graph<VertexType, Storage>::addVertex(const VertexType& v)
 {
-  for (auto& sourceVertex : _adjacencyLists) {
-    auto toRemove = sourceVertex.second.find(v);
-    if (toRemove != sourceVertex.second.end()) {
-      sourceVertex.second.erase(toRemove);
+  _version += 1;
+  detach();
+
+  _state->adjacencyLists.insert({ v, Neighbors() });
+}
+
+template<class VertexType, class Storage>
+void
+Graph<VertexType, Storage>::removeVertex(const VertexType& v)
+{
+  _version += 1;
+  detach();
+
+  if (!_state->reverseIndexed) {
+    for (auto& sourceVertex : _state->adjacencyLists) {
+      sourceVertex.second.erase(v);
     }
+
+    _state->adjacencyLists.erase(v);
+
+    return;
   }
 
-  _adjacencyLists.erase(v);
+  auto in = _state->reverseLists.find(v);
+  if (in != _state->reverseLists.end()) {
+    for (auto& sourceVertex : in->second) {
+      _state->adjacencyLists.find(sourceVertex.first)->second.erase(v);
+    }
+  }
+
+  auto out = _state->adjacencyLists.find(v);
+  if (out != _state->adjacencyLists.end()) {
+    for (auto& destVertex : out->second) {
+      _state->reverseLists.find(destVertex.first)->second.erase(v);
+    }
+  }
+
+  _state->reverseLists.erase(v);
+  _state->adjacencyLists.erase(v);
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::addEdge(const VertexType& from,
-                           const VertexType& to,
-                           int weight)
+Graph<VertexType, Storage>::addEdge(const VertexType& from,
+                                    const VertexType& to,
+                                    int weight)
 {
-  auto findTo = _adjacencyLists[from].find(to);
-  if (findTo != _adjacencyLists[from].end()) {
-    _adjacencyLists[from][to] += weight;
-  } else {
-    _adjacencyLists[from].insert({ to, weight });
+  _version += 1;
+  detach();
+
+  auto inserted = _state->adjacencyLists[from].insert({ to, weight });
+  if (!inserted.second) {
+    inserted.first->second += weight;
+  }
+
+  if (_state->reverseIndexed) {
+    _state->reverseLists[to][from] = inserted.first->second;
   }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::addNewEdge(const VertexType& from,
-                              const VertexType& to,
-                              int weight)
+Graph<VertexType, Storage>::addNewEdge(const VertexType& from,
+                                       const VertexType& to,
+                                       int weight)
 {
-  _adjacencyLists[from].insert({ to, weight });
+  _version += 1;
+  detach();
+
+  auto inserted = _state->adjacencyLists[from].insert({ to, weight }).second;
+  if (inserted && _state->reverseIndexed) {
+    _state->reverseLists[to].insert({ from, weight });
+  }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::removeEdge(const VertexType& from, const VertexType& to)
+Graph<VertexType, Storage>::removeEdge(const VertexType& from,
+                                       const VertexType& to)
 {
-  _adjacencyLists[from].erase(to);
+  _version += 1;
+  detach();
+
+  if (_state->adjacencyLists[from].erase(to) && _state->reverseIndexed) {
+    _state->reverseLists.find(to)->second.erase(from);
+  }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 bool
-Graph<VertexType>::hasEdge(const VertexType& from, const VertexType& to)
+Graph<VertexType, Storage>::hasEdge(const VertexType& from,
+                                    const VertexType& to) const
 {
-  return _adjacencyLists[from].find(to) != _adjacencyLists[from].end();
+  auto row = _state->adjacencyLists.find(from);
+
+  return row != _state->adjacencyLists.end() &&
+         row->second.find(to) != row->second.end();
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 bool
-Graph<VertexType>::hasEdges(const VertexType& from)
+Graph<VertexType, Storage>::hasEdges(const VertexType& from) const
 {
-  return _adjacencyLists[from].size() > 0;
+  auto row = _state->adjacencyLists.find(from);
+
+  return row != _state->adjacencyLists.end() && row->second.size() > 0;
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 int
-Graph<VertexType>::weight(const VertexType& from, const VertexType& to)
+Graph<VertexType, Storage>::weight(const VertexType& from,
+                                   const VertexType& to) const
 {
-  return _adjacencyLists[from][to];
+  auto row = _state->adjacencyLists.find(from);
+  if (row == _state->adjacencyLists.end()) {
+    return 0;
+  }
+
+  auto edge = row->second.find(to);
+
+  return edge != row->second.end() ? edge->second : 0;
 }
 
-template<class VertexType>
-std::map<VertexType, std::map<VertexType, int>>&
-Graph<VertexType>::getAdjacencyLists()
+template<class VertexType, class Storage>
+typename Graph<VertexType, Storage>::AdjacencyLists&
+Graph<VertexType, Storage>::getAdjacencyLists()
 {
-  return _adjacencyLists;
+  // callers may edit the lists through the reference, past the in-edge
+  // index, which is dropped until the next indexReverse(), and past
+  // copy-on-write, so later copies are made in full
+  _version += 1;
+  detach();
+
+  _state->shareable = false;
+  _state->reverseIndexed = false;
+  _state->reverseLists.clear();
+
+  return _state->adjacencyLists;
 }
 
-template<class VertexType>
-std::map<VertexType, int>&
-Graph<VertexType>::connectedTo(const VertexType& from)
+template<class VertexType, class Storage>
+const typename Graph<VertexType, Storage>::AdjacencyLists&
+Graph<VertexType, Storage>::adjacencyLists() const
 {
-  return _adjacencyLists[from];
+  return _state->adjacencyLists;
 }
 
-template<class VertexType>
-Graph<VertexType>
-Graph<VertexType>::bfs(VertexType& sourceVertex)
+template<class VertexType, class Storage>
+typename Graph<VertexType, Storage>::Neighbors&
+Graph<VertexType, Storage>::connectedTo(const VertexType& from)
 {
-  std::queue<VertexType> toSearch;
-  std::map<VertexType, bool> visited;
-  Graph<VertexType> connected;
+  _version += 1;
+  detach();
 
-  for (auto& vertex : _adjacencyLists) {
-    visited.insert(std::make_pair(vertex.first, false));
-  }
+  _state->shareable = false;
+  _state->reverseIndexed = false;
+  _state->reverseLists.clear();
 
-  visited[sourceVertex] = true;
+  return _state->adjacencyLists[from];
+}
 
-  toSearch.push(sourceVertex);
+template<class VertexType, class Storage>
+template<class Fn>
+void
+Graph<VertexType, Storage>::forEachEdge(Fn fn) const
+{
+  for (auto& sourceVertex : _state->adjacencyLists) {
+    for (auto& destVertex : sourceVertex.second) {
+      fn(sourceVertex.first, destVertex.first, destVertex.second);
+    }
+  }
+}
 
-  while (toSearch.size() > 0) {
-    auto vertex = toSearch.front();
-    toSearch.pop();
+// Keeps the in-edges of every vertex from now on, so that removeVertex,
+// edge contraction and predecessor queries take O(in-degree + out-degree)
+// instead of a pass over all vertices, at the cost of a second copy of the
+// edges. getAdjacencyLists() and connectedTo() drop the index.
+template<class VertexType, class Storage>
+void
+Graph<VertexType, Storage>::indexReverse()
+{
+  detach();
 
-    connected.addVertex(vertex);
+  _state->reverseLists.clear();
 
-    for (auto& destVertex : connectedTo(vertex)) {
-      connected.addNewEdge(vertex, destVertex.first, destVertex.second);
+  for (auto& sourceVertex : _state->adjacencyLists) {
+    for (auto& destVertex : sourceVertex.second) {
+      _state->reverseLists[destVertex.first].insert(
+        { sourceVertex.first, destVertex.second });
+    }
+  }
 
-      if (!visited[destVertex.first]) {
-        visited[destVertex.first] = true;
+  _state->reverseIndexed = true;
+}
+
+template<class VertexType, class Storage>
+bool
+Graph<VertexType, Storage>::hasReverseIndex() const
+{
+  return _state->reverseIndexed;
+}
 
-        toSearch.push(destVertex.first);
+// fn(source, weight) for every edge into v; scans all vertices without the
+// reverse index
+template<class VertexType, class Storage>
+template<class Fn>
+void
+Graph<VertexType, Storage>::forEachPredecessor(const VertexType& v,
+                                               Fn fn) const
+{
+  if (_state->reverseIndexed) {
+    auto in = _state->reverseLists.find(v);
+    if (in != _state->reverseLists.end()) {
+      for (auto& sourceVertex : in->second) {
+        fn(sourceVertex.first, sourceVertex.second);
       }
     }
+
+    return;
   }
 
-  return connected;
+  for (auto& sourceVertex : _state->adjacencyLists) {
+    auto edge = sourceVertex.second.find(v);
+    if (edge != sourceVertex.second.end()) {
+      fn(sourceVertex.first, edge->second);
+    }
+  }
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
+std::vector<VertexType>
+Graph<VertexType, Storage>::predecessors(const VertexType& v) const
+{
+  std::vector<VertexType> sources;
+
+  forEachPredecessor(
+    v, [&](const VertexType& source, int) { sources.push_back(source); });
+
+  return sources;
+}
+
+// Changes on every call that may alter the graph, so snapshots such as an
+// EdgeSampler can tell that they are out of date
+template<class VertexType, class Storage>
+std::uint64_t
+Graph<VertexType, Storage>::version() const
+{
+  return _version;
+}
+
+// Visits every vertex reachable from sourceVertex in breadth-first order as
+// visit(vertex, level, parent), with the source as its own parent; if visit
+// returns bool, false ends the search. The search walks the adjacency lists
+// in place and keeps only the queue and a set of visited vertices.
+template<class VertexType, class Storage>
+template<class Visitor>
 void
-Graph<VertexType>::contractRandomEdgeNoParallel()
+Graph<VertexType, Storage>::bfs(const VertexType& sourceVertex,
+                                Visitor visit) const
 {
-  auto edge = chooseRandomEdge();
+  auto& lists = _state->adjacencyLists;
+
+  // a visitor returning void never stops the search
+  auto proceed = [&](const VertexType& vertex,
+                     int level,
+                     const VertexType& parent) {
+    if constexpr (std::is_same<decltype(visit(vertex, level, parent)),
+                               bool>::value) {
+      return visit(vertex, level, parent);
+    } else {
+      visit(vertex, level, parent);
+      return true;
+    }
+  };
+
+  // a vertex without a row has no out-edges and only exists as a target
+  if (lists.find(sourceVertex) == lists.end()) {
+    bool isTarget = false;
+
+    if (_state->reverseIndexed) {
+      auto in = _state->reverseLists.find(sourceVertex);
+      isTarget = in != _state->reverseLists.end() && !in->second.empty();
+    } else {
+      for (auto& row : lists) {
+        if (row.second.find(sourceVertex) != row.second.end()) {
+          isTarget = true;
+          break;
+        }
+      }
+    }
 
-  for (auto& destVertex : _adjacencyLists[edge.second]) {
-    auto edgeList = _adjacencyLists[edge.first];
-    if (edgeList.find(destVertex.first) == edgeList.end()) {
-      addNewEdge(edge.first,
-                 destVertex.first,
-                 weight(edge.first, edge.second) +
-                   weight(edge.second, destVertex.first));
+    if (isTarget) {
+      proceed(sourceVertex, 0, sourceVertex);
     }
 
-    removeEdge(edge.second, destVertex.first);
+    return;
   }
 
-  for (auto& sourceVertex : _adjacencyLists) {
-    auto it = _adjacencyLists[sourceVertex.first].find(edge.second);
-    if (it != _adjacencyLists[sourceVertex.first].end()) {
-      if (_adjacencyLists[sourceVertex.first].find(edge.first) !=
-          _adjacencyLists[sourceVertex.first].end()) {
-        addNewEdge(sourceVertex.first,
-                   edge.first,
-                   weight(sourceVertex.first, edge.second));
+  typename Storage::Marks visited;
+  visited.insert({ sourceVertex, true });
+
+  std::vector<VertexType> order{ sourceVertex };
+  bool stopped = !proceed(sourceVertex, 0, sourceVertex);
+  std::size_t levelEnd = 1;
+  int level = 0;
+
+  for (std::size_t head = 0; head < order.size() && !stopped; head += 1) {
+    if (head == levelEnd) {
+      levelEnd = order.size();
+      level += 1;
+    }
+
+    // order may grow while the row is walked, so the source is copied
+    auto from = order[head];
+    auto row = lists.find(from);
+
+    if (row == lists.end()) {
+      continue;
+    }
+
+    for (auto& destVertex : row->second) {
+      if (!visited.insert({ destVertex.first, true }).second) {
+        continue;
+      }
+
+      order.push_back(destVertex.first);
+
+      if (!proceed(destVertex.first, level + 1, from)) {
+        stopped = true;
+        break;
       }
+    }
+  }
+}
+
+template<class VertexType, class Storage>
+std::vector<VertexType>
+Graph<VertexType, Storage>::reachable(const VertexType& sourceVertex) const
+{
+  std::vector<VertexType> order;
 
-      removeEdge(sourceVertex.first, edge.second);
+  bfs(sourceVertex, [&](const VertexType& vertex, int, const VertexType&) {
+    order.push_back(vertex);
+  });
+
+  return order;
+}
+
+// The given vertices with all of their out-edges; subgraph(reachable(v)) is
+// the component searched from v
+template<class VertexType, class Storage>
+Graph<VertexType>
+Graph<VertexType, Storage>::subgraph(
+  const std::vector<VertexType>& vertices) const
+{
+  Graph<VertexType> sub;
+
+  for (auto& vertex : vertices) {
+    sub.addVertex(vertex);
+
+    auto found = _state->adjacencyLists.find(vertex);
+    if (found == _state->adjacencyLists.end()) {
+      continue;
+    }
+
+    for (auto& destVertex : found->second) {
+      sub.addNewEdge(vertex, destVertex.first, destVertex.second);
     }
   }
 
-  removeVertex(edge.second);
+  return sub;
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
+CsrGraph<VertexType>
+Graph<VertexType, Storage>::freeze() const
+{
+  return CsrGraph<VertexType>(_state->adjacencyLists);
+}
+
+template<class VertexType, class Storage>
 void
-Graph<VertexType>::contractEdgeNoParallel(
+Graph<VertexType, Storage>::contractRandomEdgeNoParallel()
+{
+  contractEdgeNoParallel(chooseRandomEdge());
+}
+
+template<class VertexType, class Storage>
+void
+Graph<VertexType, Storage>::contractEdgeNoParallel(
   const std::pair<VertexType, VertexType> edge)
 {
-  for (auto& destVertex : _adjacencyLists[edge.second]) {
-    if (_adjacencyLists[edge.first].find(destVertex.first) ==
-        _adjacencyLists[edge.first].end()) {
-      addNewEdge(edge.first,
-                 destVertex.first,
-                 weight(edge.first, edge.second) +
-                   weight(edge.second, destVertex.first));
-    }
+  detach();
 
-    removeEdge(edge.second, destVertex.first);
-  }
+  auto through = weight(edge.first, edge.second);
 
-  for (auto& sourceVertex : _adjacencyLists) {
-    auto it = _adjacencyLists[sourceVertex.first].find(edge.second);
-    if (it != _adjacencyLists[sourceVertex.first].end()) {
-      if (_adjacencyLists[sourceVertex.first].find(edge.first) !=
-          _adjacencyLists[sourceVertex.first].end()) {
-        addNewEdge(sourceVertex.first,
-                   edge.first,
-                   weight(sourceVertex.first, edge.second));
-      }
+  // make both rows before holding references, as hashed lists move their
+  // rows when they grow
+  _state->adjacencyLists[edge.first];
+  _state->adjacencyLists[edge.second];
 
-      removeEdge(sourceVertex.first, edge.second);
+  auto& firstEdges = _state->adjacencyLists.find(edge.first)->second;
+  auto& secondEdges = _state->adjacencyLists.find(edge.second)->second;
+
+  // edges between the two endpoints vanish instead of becoming self-loops
+  for (auto& destVertex : secondEdges) {
+    if (destVertex.first != edge.first && destVertex.first != edge.second &&
+        firstEdges.find(destVertex.first) == firstEdges.end()) {
+      addNewEdge(edge.first, destVertex.first, through + destVertex.second);
     }
   }
 
+  // the out-edges of edge.second go with it in removeVertex, and its
+  // in-edges are gathered first, as removing them edits the index
+  std::vector<std::pair<VertexType, int>> into;
+  forEachPredecessor(
+    edge.second, [&](const VertexType& source, int edgeWeight) {
+      into.push_back({ source, edgeWeight });
+    });
+
+  for (auto& sourceVertex : into) {
+    if (sourceVertex.first != edge.first &&
+        sourceVertex.first != edge.second &&
+        !hasEdge(sourceVertex.first, edge.first)) {
+      addNewEdge(sourceVertex.first, edge.first, sourceVertex.second);
+    }
+
+    removeEdge(sourceVertex.first, edge.second);
+  }
+
   removeVertex(edge.second);
 }
 
-template<class VertexType>
+// Uniform over edges in one pass over the vertices; an EdgeSampler draws
+// in O(1) when many edges are needed between changes to the graph
+template<class VertexType, class Storage>
 std::pair<VertexType, VertexType>
-Graph<VertexType>::chooseRandomEdge()
+Graph<VertexType, Storage>::chooseRandomEdge()
 {
   std::random_device rd;
   std::mt19937 gen(rd());
 
-  auto vIt = getAdjacencyLists().begin();
-  std::forward(vIt, gen() % getAdjacencyLists().size());
-  auto startVertex = vIt->first;
+  std::size_t edges = 0;
+  for (auto& sourceVertex : _state->adjacencyLists) {
+    edges += sourceVertex.second.size();
+  }
 
-  auto eIt = vIt->second.begin();
-  while (eIt != vIt->second.end()) {
-    vIt = getAdjacencyLists().begin();
-    std::forward(vIt, gen() % getAdjacencyLists().size());
-    startVertex = vIt->first;
-    eIt = vIt->second.begin();
+  if (edges == 0) {
+    return {};
   }
 
-  std::forward(eIt, gen() % vIt->second.size());
-  auto endVertex = eIt->first;
+  auto pick = std::uniform_int_distribution<std::size_t>(0, edges - 1)(gen);
 
-  return std::make_pair(startVertex, endVertex);
+  for (auto& sourceVertex : _state->adjacencyLists) {
+    if (pick < sourceVertex.second.size()) {
+      auto eIt = sourceVertex.second.begin();
+      std::advance(eIt, pick);
+
+      return std::make_pair(sourceVertex.first, eIt->first);
+    }
+
+    pick -= sourceVertex.second.size();
+  }
+
+  return {};
 }
 
-template<class VertexType>
+template<class VertexType, class Storage>
 std::pair<VertexType, VertexType>
-Graph<VertexType>::chooseRandomEdge(VertexType& startVertex)
+Graph<VertexType, Storage>::chooseRandomEdge(VertexType& startVertex)
 {
   std::random_device rd;
   std::mt19937 gen(rd());
 
-  auto eIt = _adjacencyLists[startVertex].begin();
+  // like chooseRandomEdge(), a vertex without out-edges gives an empty pair
+  auto found = _state->adjacencyLists.find(startVertex);
+  if (found == _state->adjacencyLists.end() || found->second.empty()) {
+    return {};
+  }
+
+  auto& edges = found->second;
+  auto eIt = edges.begin();
 
-  std::forward(eIt, gen() % _adjacencyLists[startVertex].size());
+  std::advance(eIt, gen() % edges.size());
   auto endVertex = eIt->first;
 
   return std::make_pair(startVertex, endVertex);
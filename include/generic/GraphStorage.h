@@ -0,0 +1,327 @@
+#ifndef GRAPH_STORAGE_H_
+#define GRAPH_STORAGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "FlatHashMap.h"
+#include "SortedVectorMap.h"
+
+// Adjacency layouts for Graph. A policy names the container of one vertex's
+// out-edges (Neighbors, target to weight) and the container of all of them
+// (Lists, source to Neighbors). Both must offer iteration over key/value
+// pairs, find, insert, operator[], erase by key, size and clear. Marks is a
+// writable vertex to bool map that searches use as their visited set.
+
+// Ordered trees: iteration in vertex order, stable references
+template<class VertexType>
+struct OrderedStorage
+{
+  using Neighbors = std::map<VertexType, int>;
+
+  using Lists = std::map<VertexType, Neighbors>;
+
+  using Marks = std::map<VertexType, bool>;
+};
+
+// Open addressing throughout; needs std::hash<VertexType>
+template<class VertexType>
+struct HashStorage
+{
+  using Neighbors = FlatHashMap<VertexType, int>;
+
+  using Lists = FlatHashMap<VertexType, Neighbors>;
+
+  using Marks = FlatHashMap<VertexType, bool>;
+};
+
+// Hashed vertices with small sorted neighbor arrays, for bounded degree
+// graphs such as pixel lattices
+template<class VertexType>
+struct SortedVectorStorage
+{
+  using Neighbors = SortedVectorMap<VertexType, int>;
+
+  using Lists = FlatHashMap<VertexType, Neighbors>;
+
+  using Marks = FlatHashMap<VertexType, bool>;
+};
+
+template<class VertexType>
+class FrozenNeighbors
+{
+public:
+  using value_type = std::pair<VertexType, int>;
+
+  using const_iterator = const value_type*;
+
+  using iterator = const_iterator;
+
+  FrozenNeighbors();
+
+  FrozenNeighbors(const value_type* begin, const value_type* end);
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  const_iterator find(const VertexType& v) const;
+
+private:
+  const value_type* _begin = nullptr;
+
+  const value_type* _end = nullptr;
+};
+
+// All edges in one array ordered by source, then target, with a sorted row
+// per source vertex. Built from any other Lists and read-only afterwards:
+// a Graph over FrozenStorage supports the const members and clear().
+template<class VertexType>
+class FrozenLists
+{
+public:
+  using Neighbors = FrozenNeighbors<VertexType>;
+
+  using value_type = std::pair<VertexType, Neighbors>;
+
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  using iterator = const_iterator;
+
+  FrozenLists();
+
+  template<class AdjacencyLists>
+  explicit FrozenLists(const AdjacencyLists& adjacencyLists);
+
+  FrozenLists(const FrozenLists& other);
+
+  FrozenLists(FrozenLists&& other) = default;
+
+  FrozenLists& operator=(const FrozenLists& other);
+
+  FrozenLists& operator=(FrozenLists&& other) = default;
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  void clear();
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  const_iterator find(const VertexType& v) const;
+
+  const Neighbors& operator[](const VertexType& v) const;
+
+private:
+  void bindRows();
+
+  std::vector<typename Neighbors::value_type> _edges;
+
+  std::vector<std::size_t> _offsets;
+
+  std::vector<value_type> _rows;
+
+  Neighbors _none;
+};
+
+template<class VertexType>
+struct FrozenStorage
+{
+  using Neighbors = FrozenNeighbors<VertexType>;
+
+  using Lists = FrozenLists<VertexType>;
+
+  using Marks = std::map<VertexType, bool>;
+};
+
+template<class VertexType>
+FrozenNeighbors<VertexType>::FrozenNeighbors()
+{
+}
+
+template<class VertexType>
+FrozenNeighbors<VertexType>::FrozenNeighbors(const value_type* begin,
+                                             const value_type* end)
+  : _begin(begin)
+  , _end(end)
+{
+}
+
+template<class VertexType>
+std::size_t
+FrozenNeighbors<VertexType>::size() const
+{
+  return _end - _begin;
+}
+
+template<class VertexType>
+bool
+FrozenNeighbors<VertexType>::empty() const
+{
+  return _begin == _end;
+}
+
+template<class VertexType>
+typename FrozenNeighbors<VertexType>::const_iterator
+FrozenNeighbors<VertexType>::begin() const
+{
+  return _begin;
+}
+
+template<class VertexType>
+typename FrozenNeighbors<VertexType>::const_iterator
+FrozenNeighbors<VertexType>::end() const
+{
+  return _end;
+}
+
+template<class VertexType>
+typename FrozenNeighbors<VertexType>::const_iterator
+FrozenNeighbors<VertexType>::find(const VertexType& v) const
+{
+  auto it = std::lower_bound(_begin, _end, v, [](auto& edge, auto& target) {
+    return edge.first < target;
+  });
+
+  return it != _end && !(v < it->first) ? it : _end;
+}
+
+template<class VertexType>
+FrozenLists<VertexType>::FrozenLists()
+{
+}
+
+template<class VertexType>
+template<class AdjacencyLists>
+FrozenLists<VertexType>::FrozenLists(const AdjacencyLists& adjacencyLists)
+{
+  for (auto& sourceVertex : adjacencyLists) {
+    _rows.push_back({ sourceVertex.first, Neighbors() });
+  }
+
+  std::sort(_rows.begin(), _rows.end(), [](auto& row1, auto& row2) {
+    return row1.first < row2.first;
+  });
+
+  _offsets.reserve(_rows.size() + 1);
+  _offsets.push_back(0);
+
+  for (auto& row : _rows) {
+    auto begin = _edges.size();
+
+    for (auto& destVertex : adjacencyLists.find(row.first)->second) {
+      _edges.push_back({ destVertex.first, destVertex.second });
+    }
+
+    std::sort(
+      _edges.begin() + begin, _edges.end(), [](auto& edge1, auto& edge2) {
+        return edge1.first < edge2.first;
+      });
+
+    _offsets.push_back(_edges.size());
+  }
+
+  bindRows();
+}
+
+template<class VertexType>
+FrozenLists<VertexType>::FrozenLists(const FrozenLists& other)
+  : _edges(other._edges)
+  , _offsets(other._offsets)
+  , _rows(other._rows)
+{
+  bindRows();
+}
+
+template<class VertexType>
+FrozenLists<VertexType>&
+FrozenLists<VertexType>::operator=(const FrozenLists& other)
+{
+  _edges = other._edges;
+  _offsets = other._offsets;
+  _rows = other._rows;
+  bindRows();
+
+  return *this;
+}
+
+template<class VertexType>
+std::size_t
+FrozenLists<VertexType>::size() const
+{
+  return _rows.size();
+}
+
+template<class VertexType>
+bool
+FrozenLists<VertexType>::empty() const
+{
+  return _rows.empty();
+}
+
+template<class VertexType>
+void
+FrozenLists<VertexType>::clear()
+{
+  _edges.clear();
+  _offsets.clear();
+  _rows.clear();
+}
+
+template<class VertexType>
+typename FrozenLists<VertexType>::const_iterator
+FrozenLists<VertexType>::begin() const
+{
+  return _rows.begin();
+}
+
+template<class VertexType>
+typename FrozenLists<VertexType>::const_iterator
+FrozenLists<VertexType>::end() const
+{
+  return _rows.end();
+}
+
+template<class VertexType>
+typename FrozenLists<VertexType>::const_iterator
+FrozenLists<VertexType>::find(const VertexType& v) const
+{
+  auto it = std::lower_bound(
+    _rows.begin(), _rows.end(), v, [](auto& row, auto& source) {
+      return row.first < source;
+    });
+
+  return it != _rows.end() && !(v < it->first) ? it : _rows.end();
+}
+
+template<class VertexType>
+const typename FrozenLists<VertexType>::Neighbors&
+FrozenLists<VertexType>::operator[](const VertexType& v) const
+{
+  auto found = find(v);
+
+  return found != _rows.end() ? found->second : _none;
+}
+
+// rows point into _edges, so they are set again whenever _edges is copied
+template<class VertexType>
+void
+FrozenLists<VertexType>::bindRows()
+{
+  for (std::size_t row = 0; row < _rows.size(); row += 1) {
+    _rows[row].second = Neighbors(_edges.data() + _offsets[row],
+                                  _edges.data() + _offsets[row + 1]);
+  }
+}
+
+#endif // GraphStorage.h included
@@ -1,154 +1,570 @@
 #ifndef HEAP_H_
 #define HEAP_H_
 
-#include <climits>
+#include <algorithm>
+#include <cstddef>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template<class K, class T>
+// Where each item sits in a Heap, kept in a map by default.
+// DenseIndexPositions takes items as small unsigned ids, such as vertex
+// indices, and looks them up in a flat array that grows to the largest id.
+// UnindexedPositions keeps nothing, for heaps that never look items up.
+template<class T>
+class HeapPositions
+{
+public:
+  static constexpr std::size_t NoPosition = SIZE_MAX;
+
+  std::size_t get(const T& item) const;
+
+  void set(const T& item, std::size_t position);
+
+  void erase(const T& item);
+
+private:
+  std::map<T, std::size_t> _positions;
+};
+
+template<class T>
+class DenseIndexPositions
+{
+  static_assert(std::is_unsigned<T>::value, "dense ids must be unsigned");
+
+public:
+  static constexpr std::size_t NoPosition = SIZE_MAX;
+
+  std::size_t get(const T& item) const;
+
+  void set(const T& item, std::size_t position);
+
+  void erase(const T& item);
+
+private:
+  std::vector<std::size_t> _positions;
+};
+
+template<class T>
+class UnindexedPositions
+{
+public:
+  static constexpr std::size_t NoPosition = SIZE_MAX;
+
+  std::size_t get(const T& item) const;
+
+  void set(const T& item, std::size_t position);
+
+  void erase(const T& item);
+};
+
+// An indexed d-ary heap of (key, item) pairs, with the key that Compare
+// ranks first at the top; the default is a 4-ary min heap. Every item is in
+// the heap at most once and its slot is tracked, so a key can be lowered in
+// place with decreaseKey instead of inserting a duplicate. Four children
+// per node halve the depth of a binary heap, and the children compared at
+// each level of a sift down share a cache line. With UnindexedPositions
+// items may repeat and contains and decreaseKey find nothing.
+//
+// A heap given a capacity keeps at most that many entries: the ones that
+// rank last, so the largest keys of a min heap. Its top is then the weakest
+// entry kept, and an insert that does not beat it is dropped, which selects
+// the best k of n streamed items in O(n log k).
+template<class K,
+         class T,
+         class Compare = std::less<K>,
+         std::size_t Arity = 4,
+         class Positions = HeapPositions<T>>
 class Heap
 {
+  static_assert(Arity >= 2, "a heap node needs at least two children");
+
 public:
-  Heap();
+  explicit Heap(Compare compare = Compare());
+
+  template<class InputIt>
+  Heap(InputIt first, InputIt last, Compare compare = Compare());
+
+  template<class InputIt>
+  void assign(InputIt first, InputIt last);
 
   void insert(K key, T item);
 
+  void meld(Heap& other);
+
+  bool decreaseKey(const T& item, K key);
+
+  bool contains(const T& item) const;
+
+  const std::pair<K, T>& top() const;
+
   T extractMin();
 
+  std::vector<std::pair<K, T>> extractTopK(std::size_t k);
+
+  std::vector<std::pair<K, T>> peekTopK(std::size_t k) const;
+
   void heapify();
 
-  bool empty();
+  bool empty() const;
 
-private:
-  int parent(int index);
+  std::size_t size() const;
 
-  int leftChild(int index);
+  void clear();
 
-  int rightChild(int index);
+  void setCapacity(std::size_t capacity);
 
-  void swap(int left, int right);
+  std::size_t capacity() const;
 
 private:
-  std::vector<std::pair<K, T>> heap;
+  static std::size_t parent(std::size_t index);
+
+  static std::size_t firstChild(std::size_t index);
+
+  void append(K key, T item);
+
+  void place(std::size_t index, std::pair<K, T> entry);
+
+  void siftUp(std::size_t index);
+
+  void siftDown(std::size_t index);
+
+  std::vector<std::pair<K, T>> _entries;
+
+  Positions _positions;
+
+  Compare _compare;
+
+  std::size_t _capacity = SIZE_MAX;
 };
 
-template<class K, class T>
-Heap<K, T>::Heap()
+template<class T>
+std::size_t
+HeapPositions<T>::get(const T& item) const
+{
+  auto found = _positions.find(item);
+
+  return found != _positions.end() ? found->second : NoPosition;
+}
+
+template<class T>
+void
+HeapPositions<T>::set(const T& item, std::size_t position)
 {
-  this->heap.push_back({ INT_MAX, T() });
+  _positions[item] = position;
 }
 
-template<class K, class T>
+template<class T>
 void
-Heap<K, T>::insert(K key, T item)
+HeapPositions<T>::erase(const T& item)
+{
+  _positions.erase(item);
+}
+
+template<class T>
+std::size_t
+DenseIndexPositions<T>::get(const T& item) const
 {
-  this->heap.push_back({ key, item });
-  auto itemIndex = this->heap.size() - 1;
+  auto id = static_cast<std::size_t>(item);
 
-  while (itemIndex > 1 &&
-         heap[itemIndex].first < heap[parent(itemIndex)].first) {
-    this->swap(itemIndex, parent(itemIndex));
-    itemIndex = parent(itemIndex);
+  return id < _positions.size() ? _positions[id] : NoPosition;
+}
+
+template<class T>
+void
+DenseIndexPositions<T>::set(const T& item, std::size_t position)
+{
+  auto id = static_cast<std::size_t>(item);
+
+  if (id >= _positions.size()) {
+    _positions.resize(std::max(id + 1, _positions.size() * 2), NoPosition);
   }
+
+  _positions[id] = position;
 }
 
-template<class K, class T>
-T
-Heap<K, T>::extractMin()
+template<class T>
+void
+DenseIndexPositions<T>::erase(const T& item)
 {
-  auto minimum = this->heap[1].second;
-  this->heap[1] = this->heap[this->heap.size() - 1];
-  this->heap.pop_back();
+  _positions[static_cast<std::size_t>(item)] = NoPosition;
+}
 
-  auto outerIndex = 1;
-  auto innerIndex = 0;
-  auto isHeap = false;
+template<class T>
+std::size_t
+UnindexedPositions<T>::get(const T&) const
+{
+  return NoPosition;
+}
 
-  while (!isHeap && outerIndex * 2 < this->heap.size()) {
-    innerIndex = leftChild(outerIndex);
+template<class T>
+void
+UnindexedPositions<T>::set(const T&, std::size_t)
+{
+}
 
-    if (innerIndex < this->heap.size() - 1) {
-      if (this->heap[innerIndex].first > this->heap[innerIndex + 1].first) {
-        innerIndex += 1;
-      }
+template<class T>
+void
+UnindexedPositions<T>::erase(const T&)
+{
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+Heap<K, T, Compare, Arity, Positions>::Heap(Compare compare)
+  : _compare(compare)
+{
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+template<class InputIt>
+Heap<K, T, Compare, Arity, Positions>::Heap(InputIt first,
+                                            InputIt last,
+                                            Compare compare)
+  : _compare(compare)
+{
+  assign(first, last);
+}
+
+// Replaces the contents with a range of (key, item) pairs in O(n), a
+// repeated item keeping the key that ranks first. With a capacity, the
+// first capacity items are heapified and the rest offered one by one.
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+template<class InputIt>
+void
+Heap<K, T, Compare, Arity, Positions>::assign(InputIt first, InputIt last)
+{
+  clear();
+
+  for (; first != last && _entries.size() < _capacity; ++first) {
+    append(first->first, first->second);
+  }
+
+  heapify();
+
+  for (; first != last; ++first) {
+    insert(first->first, first->second);
+  }
+}
+
+// An item that is already queued keeps the key that ranks first, as it
+// does in append, so inserting never makes a key worse
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::insert(K key, T item)
+{
+  auto index = _positions.get(item);
+
+  if (index != Positions::NoPosition) {
+    decreaseKey(item, std::move(key));
+
+    return;
+  }
+
+  if (_entries.size() >= _capacity) {
+    if (_capacity == 0 || !_compare(_entries.front().first, key)) {
+      return;
     }
 
-    // not a min heap
-    if (this->heap[innerIndex].first < this->heap[outerIndex].first) {
-      this->swap(innerIndex, outerIndex);
-      outerIndex = innerIndex;
+    _positions.erase(_entries.front().second);
+    place(0, { std::move(key), item });
+    siftDown(0);
+
+    return;
+  }
+
+  _entries.push_back({ std::move(key), item });
+  _positions.set(item, _entries.size() - 1);
+  siftUp(_entries.size() - 1);
+}
+
+// Moves every entry of other into this heap and empties other; an item in
+// both keeps the key that ranks first. A large other is appended and the
+// whole heap rebuilt in O(n + m), a small one inserted in O(m log(n + m)).
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::meld(Heap& other)
+{
+  if (this == &other) {
+    return;
+  }
+
+  auto total = static_cast<double>(size() + other.size());
+  bool rebuild = _capacity == SIZE_MAX &&
+                 other.size() * std::log2(total + 1) >= total;
+
+  for (auto& entry : other._entries) {
+    if (rebuild) {
+      append(std::move(entry.first), entry.second);
     } else {
-      isHeap = true;
+      insert(std::move(entry.first), entry.second);
     }
   }
 
+  if (rebuild) {
+    heapify();
+  }
+
+  other.clear();
+}
+
+// Moves a queued item up to key; false if the item is not queued or key
+// does not rank before its current one
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+bool
+Heap<K, T, Compare, Arity, Positions>::decreaseKey(const T& item, K key)
+{
+  auto index = _positions.get(item);
+
+  if (index == Positions::NoPosition ||
+      !_compare(key, _entries[index].first)) {
+    return false;
+  }
+
+  _entries[index].first = std::move(key);
+  siftUp(index);
+
+  return true;
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+bool
+Heap<K, T, Compare, Arity, Positions>::contains(const T& item) const
+{
+  return _positions.get(item) != Positions::NoPosition;
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+const std::pair<K, T>&
+Heap<K, T, Compare, Arity, Positions>::top() const
+{
+  return _entries.front();
+}
+
+// Returns T() on an empty heap
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+T
+Heap<K, T, Compare, Arity, Positions>::extractMin()
+{
+  if (_entries.empty()) {
+    return T();
+  }
+
+  auto minimum = std::move(_entries.front().second);
+  _positions.erase(minimum);
+
+  auto last = std::move(_entries.back());
+  _entries.pop_back();
+
+  if (!_entries.empty()) {
+    place(0, std::move(last));
+    siftDown(0);
+  }
+
   return minimum;
 }
 
-template<class K, class T>
-void
-Heap<K, T>::heapify()
+// Removes up to k entries, in the order extractMin would return them
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::vector<std::pair<K, T>>
+Heap<K, T, Compare, Arity, Positions>::extractTopK(std::size_t k)
 {
-  for (auto index = std::floor(this->heap.size() / 2); index > 0; index -= 1) {
-    auto outerIndex = index;
-    auto innerIndex = index;
-    auto isHeap = false;
+  std::vector<std::pair<K, T>> top;
+  top.reserve(std::min(k, _entries.size()));
 
-    while (!isHeap && outerIndex * 2 < this->heap.size()) {
-      innerIndex = leftChild(outerIndex);
+  while (top.size() < k && !_entries.empty()) {
+    top.push_back(_entries.front());
+    extractMin();
+  }
 
-      if (innerIndex < this->heap.size() - 1) {
-        if (this->heap[innerIndex].first > this->heap[innerIndex + 1].first) {
-          innerIndex += 1;
-        }
-      }
+  return top;
+}
 
-      // not a min heap
-      if (this->heap[innerIndex].first < this->heap[outerIndex].first) {
-        this->swap(innerIndex, outerIndex);
-        outerIndex = innerIndex;
-      } else {
-        isHeap = true;
-      }
+// The first k entries in extractMin order without removing them, in
+// O(k log k): only the children of entries already taken can come next
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::vector<std::pair<K, T>>
+Heap<K, T, Compare, Arity, Positions>::peekTopK(std::size_t k) const
+{
+  std::vector<std::pair<K, T>> top;
+  std::vector<std::size_t> frontier;
+
+  // std heaps put the largest first, so the comparison is reversed
+  auto after = [&](std::size_t i, std::size_t j) {
+    return _compare(_entries[j].first, _entries[i].first);
+  };
+
+  if (k > 0 && !_entries.empty()) {
+    frontier.push_back(0);
+  }
+
+  while (top.size() < k && !frontier.empty()) {
+    std::pop_heap(frontier.begin(), frontier.end(), after);
+    auto index = frontier.back();
+    frontier.pop_back();
+
+    top.push_back(_entries[index]);
+
+    auto first = firstChild(index);
+    auto last = std::min(first + Arity, _entries.size());
+
+    for (auto child = first; child < last; child += 1) {
+      frontier.push_back(child);
+      std::push_heap(frontier.begin(), frontier.end(), after);
     }
   }
+
+  return top;
 }
 
-template<class K, class T>
+// Restores heap order over all entries bottom-up in O(n)
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::heapify()
+{
+  if (_entries.size() < 2) {
+    return;
+  }
+
+  for (auto index = parent(_entries.size() - 1) + 1; index > 0; index -= 1) {
+    siftDown(index - 1);
+  }
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
 bool
-Heap<K, T>::empty()
+Heap<K, T, Compare, Arity, Positions>::empty() const
+{
+  return _entries.empty();
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::size_t
+Heap<K, T, Compare, Arity, Positions>::size() const
+{
+  return _entries.size();
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::clear()
+{
+  for (auto& entry : _entries) {
+    _positions.erase(entry.second);
+  }
+
+  _entries.clear();
+}
+
+// Evicts entries from the top until at most capacity remain
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::setCapacity(std::size_t capacity)
+{
+  _capacity = capacity;
+
+  while (_entries.size() > _capacity) {
+    extractMin();
+  }
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::size_t
+Heap<K, T, Compare, Arity, Positions>::capacity() const
+{
+  return _capacity;
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::size_t
+Heap<K, T, Compare, Arity, Positions>::parent(std::size_t index)
+{
+  return (index - 1) / Arity;
+}
+
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+std::size_t
+Heap<K, T, Compare, Arity, Positions>::firstChild(std::size_t index)
 {
-  return this->heap.size() == 0;
+  return index * Arity + 1;
 }
 
-template<class K, class T>
-int
-Heap<K, T>::parent(int index)
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::place(std::size_t index,
+                                             std::pair<K, T> entry)
 {
-  return std::floor(((index) / 2));
+  _positions.set(entry.second, index);
+  _entries[index] = std::move(entry);
 }
 
-template<class K, class T>
-int
-Heap<K, T>::leftChild(int index)
+// Adds an entry without restoring heap order, for a heapify() to follow
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::append(K key, T item)
 {
-  return ((index)*2);
+  auto index = _positions.get(item);
+
+  if (index == Positions::NoPosition) {
+    _entries.push_back({ std::move(key), item });
+    _positions.set(item, _entries.size() - 1);
+  } else if (_compare(key, _entries[index].first)) {
+    _entries[index].first = std::move(key);
+  }
 }
 
-template<class K, class T>
-int
-Heap<K, T>::rightChild(int index)
+// Both sifts carry the entry in hand and shift the others into the hole,
+// which writes every slot once instead of swapping
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
+void
+Heap<K, T, Compare, Arity, Positions>::siftUp(std::size_t index)
 {
-  return (index)*2 + 1;
+  auto entry = std::move(_entries[index]);
+
+  while (index > 0) {
+    auto up = parent(index);
+
+    if (!_compare(entry.first, _entries[up].first)) {
+      break;
+    }
+
+    place(index, std::move(_entries[up]));
+    index = up;
+  }
+
+  place(index, std::move(entry));
 }
 
-template<class K, class T>
+template<class K, class T, class Compare, std::size_t Arity, class Positions>
 void
-Heap<K, T>::swap(int left, int right)
+Heap<K, T, Compare, Arity, Positions>::siftDown(std::size_t index)
 {
-  auto temp = this->heap[left];
-  this->heap[left] = this->heap[right];
-  this->heap[right] = temp;
+  auto entry = std::move(_entries[index]);
+  auto size = _entries.size();
+
+  while (firstChild(index) < size) {
+    auto first = firstChild(index);
+    auto last = std::min(first + Arity, size);
+    auto best = first;
+
+    for (auto child = first + 1; child < last; child += 1) {
+      if (_compare(_entries[child].first, _entries[best].first)) {
+        best = child;
+      }
+    }
+
+    if (!_compare(_entries[best].first, entry.first)) {
+      break;
+    }
+
+    place(index, std::move(_entries[best]));
+    index = best;
+  }
+
+  place(index, std::move(entry));
 }
 
 #endif // Heap.h included
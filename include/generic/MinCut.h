@@ -0,0 +1,365 @@
+#ifndef MIN_CUT_H_
+#define MIN_CUT_H_
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../util/Parallel.h"
+#include "../util/Philox.h"
+#include "EdgeList.h"
+#include "UnionFind.h"
+
+// Global minimum cut of the undirected edges of an index graph (see
+// undirectedEdges), taking weights as capacities; edges with a weight of
+// zero or less are left out. A contraction draws an exponential arrival
+// time per edge with the weight as rate and unites edges in arrival order
+// until few enough components remain, which is random weighted contraction
+// done as one sort over a flat edge list. run() repeats Karger-Stein
+// recursion, O(V^2 log V) per trial; runKarger() contracts straight down to
+// two vertices in O(E log E), which suits graphs of millions of edges. Trials
+// run in parallel, each with its own generator seeded from (seed, trial),
+// and the lightest cut wins, the earliest trial on ties.
+template<class GraphType>
+class MinCut
+{
+public:
+  using Index = std::uint32_t;
+
+  MinCut(const GraphType& graph, WorkerPool& pool);
+
+  void run(int trials = 16, std::uint64_t seed = 0);
+
+  void runKarger(int trials = 16, std::uint64_t seed = 0);
+
+  long long value() const;
+
+  const std::vector<std::uint8_t>& side() const;
+
+private:
+  struct Cut
+  {
+    long long value = LLONG_MAX;
+    std::vector<std::uint8_t> side;
+  };
+
+  using Random = std::mt19937_64;
+
+  template<class Trial>
+  void runTrials(int trials, std::uint64_t seed, Trial trial);
+
+  static std::vector<Index> contract(Index vertices,
+                                     const std::vector<WeightedEdge>& edges,
+                                     Index target,
+                                     Random& random,
+                                     Index& components);
+
+  static std::vector<WeightedEdge> crossing(
+    const std::vector<WeightedEdge>& edges,
+    const std::vector<Index>& labels);
+
+  static Cut karger(Index vertices,
+                    const std::vector<WeightedEdge>& edges,
+                    Random& random);
+
+  static Cut kargerStein(Index vertices,
+                         const std::vector<WeightedEdge>& edges,
+                         Random& random);
+
+  static Cut exhaustive(Index vertices, const std::vector<WeightedEdge>& edges);
+
+  const GraphType& _graph;
+
+  WorkerPool& _pool;
+
+  long long _value = 0;
+
+  std::vector<std::uint8_t> _side;
+};
+
+template<class GraphType>
+MinCut<GraphType>::MinCut(const GraphType& graph, WorkerPool& pool)
+  : _graph(graph)
+  , _pool(pool)
+{
+}
+
+template<class GraphType>
+void
+MinCut<GraphType>::run(int trials, std::uint64_t seed)
+{
+  runTrials(trials, seed, &MinCut::kargerStein);
+}
+
+template<class GraphType>
+void
+MinCut<GraphType>::runKarger(int trials, std::uint64_t seed)
+{
+  runTrials(trials, seed, &MinCut::karger);
+}
+
+template<class GraphType>
+long long
+MinCut<GraphType>::value() const
+{
+  return _value;
+}
+
+template<class GraphType>
+const std::vector<std::uint8_t>&
+MinCut<GraphType>::side() const
+{
+  return _side;
+}
+
+template<class GraphType>
+template<class Trial>
+void
+MinCut<GraphType>::runTrials(int trials, std::uint64_t seed, Trial trial)
+{
+  auto edges = undirectedEdges(_graph, _pool);
+  edges.erase(std::remove_if(edges.begin(),
+                             edges.end(),
+                             [](const auto& edge) { return edge.weight <= 0; }),
+              edges.end());
+
+  Index vertices = _graph.size();
+  _value = 0;
+  _side.assign(vertices, 0);
+
+  if (vertices < 2 || trials <= 0) {
+    return;
+  }
+
+  Philox rng(seed);
+  std::vector<Cut> best(_pool.size());
+  std::vector<int> bestTrial(_pool.size(), INT_MAX);
+
+  _pool.parallelFor(
+    trials,
+    [&](int worker, std::size_t begin, std::size_t end) {
+      for (auto t = begin; t < end; t += 1) {
+        auto block = rng(t);
+        Random random((static_cast<std::uint64_t>(block[1]) << 32) |
+                      block[0]);
+
+        auto cut = trial(vertices, edges, random);
+        if (cut.value < best[worker].value) {
+          best[worker] = std::move(cut);
+          bestTrial[worker] = t;
+        }
+      }
+    },
+    1);
+
+  // workers run ascending slices of trials, so the first strict minimum
+  // over workers is the earliest trial to reach it
+  std::size_t winner = 0;
+  for (std::size_t worker = 1; worker < best.size(); worker += 1) {
+    if (best[worker].value < best[winner].value ||
+        (best[worker].value == best[winner].value &&
+         bestTrial[worker] < bestTrial[winner])) {
+      winner = worker;
+    }
+  }
+
+  _value = best[winner].value;
+  _side = std::move(best[winner].side);
+}
+
+// Unites edges in the order of exponential arrival times until at most
+// target components remain; returns each vertex's component in
+// [0, components)
+template<class GraphType>
+std::vector<typename MinCut<GraphType>::Index>
+MinCut<GraphType>::contract(Index vertices,
+                            const std::vector<WeightedEdge>& edges,
+                            Index target,
+                            Random& random,
+                            Index& components)
+{
+  std::vector<double> arrivals(edges.size());
+  std::vector<std::uint32_t> order(edges.size());
+
+  for (std::size_t e = 0; e < edges.size(); e += 1) {
+    std::exponential_distribution<double> arrival(edges[e].weight);
+    arrivals[e] = arrival(random);
+  }
+
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](auto e1, auto e2) {
+    return arrivals[e1] < arrivals[e2];
+  });
+
+  DenseUnionFind<Index> sets(vertices);
+
+  for (auto e : order) {
+    if (sets.components() <= target) {
+      break;
+    }
+
+    sets.unionVertices(edges[e].from, edges[e].to);
+  }
+
+  auto leaders = sets.flatten();
+  std::vector<Index> labels(vertices);
+  std::vector<Index> renamed(vertices, UINT32_MAX);
+  components = 0;
+
+  for (Index v = 0; v < vertices; v += 1) {
+    auto& name = renamed[leaders[v]];
+
+    if (name == UINT32_MAX) {
+      name = components;
+      components += 1;
+    }
+
+    labels[v] = name;
+  }
+
+  return labels;
+}
+
+// The edges between different components, renamed to their labels, with
+// parallel edges merged into one of their total weight; a total beyond int
+// starts another parallel edge, which keeps cut values and rates exact
+template<class GraphType>
+std::vector<WeightedEdge>
+MinCut<GraphType>::crossing(const std::vector<WeightedEdge>& edges,
+                            const std::vector<Index>& labels)
+{
+  std::vector<WeightedEdge> renamed;
+
+  for (auto& edge : edges) {
+    auto from = labels[edge.from];
+    auto to = labels[edge.to];
+
+    if (from != to) {
+      renamed.push_back(
+        { std::min(from, to), std::max(from, to), edge.weight });
+    }
+  }
+
+  std::sort(renamed.begin(), renamed.end(), [](auto& e1, auto& e2) {
+    return e1.from != e2.from ? e1.from < e2.from : e1.to < e2.to;
+  });
+
+  std::vector<WeightedEdge> merged;
+
+  for (auto& edge : renamed) {
+    if (!merged.empty() && merged.back().from == edge.from &&
+        merged.back().to == edge.to &&
+        static_cast<long long>(merged.back().weight) + edge.weight <=
+          INT_MAX) {
+      merged.back().weight += edge.weight;
+    } else {
+      merged.push_back(edge);
+    }
+  }
+
+  return merged;
+}
+
+template<class GraphType>
+typename MinCut<GraphType>::Cut
+MinCut<GraphType>::karger(Index vertices,
+                          const std::vector<WeightedEdge>& edges,
+                          Random& random)
+{
+  Index components = 0;
+  auto labels = contract(vertices, edges, 2, random, components);
+
+  Cut cut;
+  cut.value = 0;
+  cut.side.resize(vertices);
+
+  // a disconnected graph ends with more components, and a zero cut around
+  // the component of vertex 0
+  for (Index v = 0; v < vertices; v += 1) {
+    cut.side[v] = labels[v] != labels[0];
+  }
+
+  for (auto& edge : edges) {
+    if (cut.side[edge.from] != cut.side[edge.to]) {
+      cut.value += edge.weight;
+    }
+  }
+
+  return cut;
+}
+
+template<class GraphType>
+typename MinCut<GraphType>::Cut
+MinCut<GraphType>::kargerStein(Index vertices,
+                               const std::vector<WeightedEdge>& edges,
+                               Random& random)
+{
+  if (edges.empty()) {
+    Cut cut;
+    cut.value = 0;
+    cut.side.assign(vertices, 1);
+    cut.side[0] = 0;
+
+    return cut;
+  }
+
+  if (vertices <= 6) {
+    return exhaustive(vertices, edges);
+  }
+
+  auto target = static_cast<Index>(std::ceil(1 + vertices / std::sqrt(2.)));
+  Cut best;
+
+  for (int branch = 0; branch < 2; branch += 1) {
+    Index components = 0;
+    auto labels = contract(vertices, edges, target, random, components);
+    auto cut = kargerStein(components, crossing(edges, labels), random);
+
+    if (cut.value < best.value) {
+      best.value = cut.value;
+      best.side.resize(vertices);
+
+      for (Index v = 0; v < vertices; v += 1) {
+        best.side[v] = cut.side[labels[v]];
+      }
+    }
+  }
+
+  return best;
+}
+
+// tries every split that keeps the last vertex on side 0
+template<class GraphType>
+typename MinCut<GraphType>::Cut
+MinCut<GraphType>::exhaustive(Index vertices,
+                              const std::vector<WeightedEdge>& edges)
+{
+  Cut best;
+  best.side.resize(vertices);
+
+  for (unsigned mask = 1; mask < (1u << (vertices - 1)); mask += 1) {
+    long long value = 0;
+
+    for (auto& edge : edges) {
+      if (((mask >> edge.from) ^ (mask >> edge.to)) & 1) {
+        value += edge.weight;
+      }
+    }
+
+    if (value < best.value) {
+      best.value = value;
+
+      for (Index v = 0; v < vertices; v += 1) {
+        best.side[v] = (mask >> v) & 1;
+      }
+    }
+  }
+
+  return best;
+}
+
+#endif // MinCut.h included
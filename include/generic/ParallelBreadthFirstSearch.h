@@ -0,0 +1,308 @@
+#ifndef PARALLEL_BREADTH_FIRST_SEARCH_H_
+#define PARALLEL_BREADTH_FIRST_SEARCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "../util/Parallel.h"
+
+// Level-synchronous parallel breadth-first search with direction
+// optimization (Beamer, Asanovic & Patterson). Small frontiers are expanded
+// top-down from a vertex list, claiming vertices by setting their visited
+// bit atomically. Once the frontier is large next to the unvisited rest,
+// the search turns bottom-up: every unvisited vertex looks for an
+// in-neighbor in a bitmap of the frontier and stops at the first one, and
+// each worker owns whole 64-vertex words of the bitmaps. Bottom-up steps
+// need forEachInNeighbor(v, fn(from, weight)), where fn returning false
+// ends the walk, and are skipped when the graph has no reverse index.
+// Levels match those of the serial search.
+template<class GraphType>
+class ParallelBreadthFirstSearch
+{
+public:
+  using Index = std::uint32_t;
+
+  static constexpr int Unreached = -1;
+
+  ParallelBreadthFirstSearch(const GraphType& graph, WorkerPool& pool);
+
+  void run(Index source);
+
+  std::size_t reached() const;
+
+  const std::vector<int>& levels() const;
+
+  std::vector<int> takeLevels();
+
+private:
+  // top-down while the frontier holds fewer than 1 / Alpha of the unvisited
+  // vertices, and back once it holds fewer than 1 / Beta of all of them
+  static constexpr std::size_t Alpha = 14;
+
+  static constexpr std::size_t Beta = 24;
+
+  std::size_t topDown(int level);
+
+  std::size_t bottomUp(int level);
+
+  void frontierToBitmap();
+
+  void bitmapToFrontier();
+
+  bool inFrontier(Index vertex) const;
+
+  const GraphType& _graph;
+
+  WorkerPool& _pool;
+
+  std::vector<std::atomic<std::uint64_t>> _visited;
+
+  std::vector<std::atomic<std::uint64_t>> _frontierBits;
+
+  std::vector<std::atomic<std::uint64_t>> _nextBits;
+
+  std::vector<Index> _frontier;
+
+  std::vector<std::vector<Index>> _next;
+
+  std::vector<std::size_t> _counts;
+
+  std::vector<int> _levels;
+
+  std::size_t _reached = 0;
+};
+
+template<class GraphType>
+ParallelBreadthFirstSearch<GraphType>::ParallelBreadthFirstSearch(
+  const GraphType& graph,
+  WorkerPool& pool)
+  : _graph(graph)
+  , _pool(pool)
+{
+}
+
+template<class GraphType>
+void
+ParallelBreadthFirstSearch<GraphType>::run(Index source)
+{
+  std::size_t size = _graph.size();
+  std::size_t words = (size + 63) / 64;
+
+  _visited = std::vector<std::atomic<std::uint64_t>>(words);
+  _frontierBits = std::vector<std::atomic<std::uint64_t>>(words);
+  _nextBits = std::vector<std::atomic<std::uint64_t>>(words);
+  _next.assign(_pool.size(), {});
+  _counts.assign(_pool.size(), 0);
+  _levels.assign(size, Unreached);
+  _frontier.clear();
+  _reached = 0;
+
+  _pool.parallelFor(words, [&](int, std::size_t begin, std::size_t end) {
+    for (auto w = begin; w < end; w += 1) {
+      _visited[w].store(0, std::memory_order_relaxed);
+      _frontierBits[w].store(0, std::memory_order_relaxed);
+      _nextBits[w].store(0, std::memory_order_relaxed);
+    }
+  });
+
+  if (source >= size) {
+    return;
+  }
+
+  _visited[source / 64].store(std::uint64_t(1) << (source % 64),
+                              std::memory_order_relaxed);
+  _levels[source] = 0;
+  _frontier.push_back(source);
+  _reached = 1;
+
+  bool bottomUpAllowed = _graph.hasReverseIndex();
+  bool bottomUpMode = false;
+  std::size_t frontierSize = 1;
+
+  for (int level = 0; frontierSize > 0; level += 1) {
+    if (!bottomUpMode && bottomUpAllowed &&
+        frontierSize > (size - _reached) / Alpha) {
+      frontierToBitmap();
+      bottomUpMode = true;
+    } else if (bottomUpMode && frontierSize < size / Beta) {
+      bitmapToFrontier();
+      bottomUpMode = false;
+    }
+
+    frontierSize = bottomUpMode ? bottomUp(level) : topDown(level);
+    _reached += frontierSize;
+  }
+}
+
+template<class GraphType>
+std::size_t
+ParallelBreadthFirstSearch<GraphType>::reached() const
+{
+  return _reached;
+}
+
+template<class GraphType>
+const std::vector<int>&
+ParallelBreadthFirstSearch<GraphType>::levels() const
+{
+  return _levels;
+}
+
+template<class GraphType>
+std::vector<int>
+ParallelBreadthFirstSearch<GraphType>::takeLevels()
+{
+  return std::move(_levels);
+}
+
+template<class GraphType>
+std::size_t
+ParallelBreadthFirstSearch<GraphType>::topDown(int level)
+{
+  _pool.parallelFor(
+    _frontier.size(),
+    [&](int worker, std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; i += 1) {
+        _graph.forEachNeighbor(_frontier[i], [&](Index to, auto) {
+          auto& word = _visited[to / 64];
+          std::uint64_t bit = std::uint64_t(1) << (to % 64);
+
+          if (word.load(std::memory_order_relaxed) & bit) {
+            return;
+          }
+
+          if (!(word.fetch_or(bit, std::memory_order_relaxed) & bit)) {
+            _levels[to] = level + 1;
+            _next[worker].push_back(to);
+          }
+        });
+      }
+    },
+    256);
+
+  _frontier.clear();
+  for (auto& next : _next) {
+    _frontier.insert(_frontier.end(), next.begin(), next.end());
+    next.clear();
+  }
+
+  return _frontier.size();
+}
+
+template<class GraphType>
+std::size_t
+ParallelBreadthFirstSearch<GraphType>::bottomUp(int level)
+{
+  std::size_t size = _graph.size();
+
+  for (auto& count : _counts) {
+    count = 0;
+  }
+
+  _pool.parallelFor(
+    _visited.size(),
+    [&](int worker, std::size_t begin, std::size_t end) {
+      for (auto w = begin; w < end; w += 1) {
+        auto visited = _visited[w].load(std::memory_order_relaxed);
+        auto unvisited = ~visited;
+        std::uint64_t next = 0;
+
+        if (w == _visited.size() - 1 && size % 64 != 0) {
+          unvisited &= (std::uint64_t(1) << (size % 64)) - 1;
+        }
+
+        while (unvisited != 0) {
+          int bit = __builtin_ctzll(unvisited);
+          unvisited &= unvisited - 1;
+
+          Index v = static_cast<Index>(w * 64 + bit);
+          bool found = false;
+
+          _graph.forEachInNeighbor(v, [&](Index from, auto) {
+            found = inFrontier(from);
+            return !found;
+          });
+
+          if (found) {
+            next |= std::uint64_t(1) << bit;
+            _levels[v] = level + 1;
+            _counts[worker] += 1;
+          }
+        }
+
+        _nextBits[w].store(next, std::memory_order_relaxed);
+        _visited[w].store(visited | next, std::memory_order_relaxed);
+      }
+    },
+    64);
+
+  _frontierBits.swap(_nextBits);
+
+  std::size_t frontierSize = 0;
+  for (auto count : _counts) {
+    frontierSize += count;
+  }
+
+  return frontierSize;
+}
+
+template<class GraphType>
+void
+ParallelBreadthFirstSearch<GraphType>::frontierToBitmap()
+{
+  _pool.parallelFor(
+    _frontierBits.size(), [&](int, std::size_t begin, std::size_t end) {
+      for (auto w = begin; w < end; w += 1) {
+        _frontierBits[w].store(0, std::memory_order_relaxed);
+      }
+    });
+
+  _pool.parallelFor(
+    _frontier.size(), [&](int, std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; i += 1) {
+        auto v = _frontier[i];
+        _frontierBits[v / 64].fetch_or(std::uint64_t(1) << (v % 64),
+                                       std::memory_order_relaxed);
+      }
+    });
+
+  _frontier.clear();
+}
+
+template<class GraphType>
+void
+ParallelBreadthFirstSearch<GraphType>::bitmapToFrontier()
+{
+  _pool.parallelFor(
+    _frontierBits.size(),
+    [&](int worker, std::size_t begin, std::size_t end) {
+      for (auto w = begin; w < end; w += 1) {
+        auto bits = _frontierBits[w].load(std::memory_order_relaxed);
+
+        while (bits != 0) {
+          int bit = __builtin_ctzll(bits);
+          bits &= bits - 1;
+          _next[worker].push_back(static_cast<Index>(w * 64 + bit));
+        }
+      }
+    },
+    64);
+
+  _frontier.clear();
+  for (auto& next : _next) {
+    _frontier.insert(_frontier.end(), next.begin(), next.end());
+    next.clear();
+  }
+}
+
+template<class GraphType>
+bool
+ParallelBreadthFirstSearch<GraphType>::inFrontier(Index vertex) const
+{
+  auto word = _frontierBits[vertex / 64].load(std::memory_order_relaxed);
+
+  return (word >> (vertex % 64)) & 1;
+}
+
+#endif // ParallelBreadthFirstSearch.h included
@@ -0,0 +1,395 @@
+#ifndef SHORTEST_PATHS_H_
+#define SHORTEST_PATHS_H_
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Heap.h"
+
+struct ShortestPathSeed
+{
+  std::uint32_t vertex;
+  int offset;
+};
+
+struct ShortestPathLimits
+{
+  int maxDistance = INT_MAX;
+  std::size_t maxVertices = SIZE_MAX;
+};
+
+// Shortest paths over any index graph that provides size(), maxWeight() and
+// forEachNeighbor(v, fn(to, weight)). Small non-negative integer weights use
+// Dial's bucket queue, which is linear in V + E plus the largest distance;
+// anything else falls back to an indexed 4-ary heap.
+//
+// A search may start from several seeds, each with an initial distance, and
+// then also records which seed every reached vertex is closest to. It stops
+// expanding past maxDistance, and after settling maxVertices vertices; any
+// vertex that was not settled by then is left Unreachable.
+template<class GraphType>
+class ShortestPaths
+{
+public:
+  using Index = std::uint32_t;
+
+  static constexpr Index NoVertex = UINT32_MAX;
+
+  static constexpr int Unreachable = INT_MAX;
+
+  static constexpr int MaxBucketWeight = 1 << 12;
+
+  using Seed = ShortestPathSeed;
+
+  using Limits = ShortestPathLimits;
+
+  explicit ShortestPaths(const GraphType& graph);
+
+  void run(Index source, bool withPredecessors = false);
+
+  void run(const std::vector<Seed>& seeds,
+           Limits limits,
+           bool withPredecessors = false);
+
+  const std::vector<int>& distances() const;
+
+  const std::vector<Index>& predecessors() const;
+
+  const std::vector<Index>& labels() const;
+
+  std::vector<int> takeDistances();
+
+  std::vector<Index> takePredecessors();
+
+  std::vector<Index> takeLabels();
+
+private:
+  void search(std::vector<Seed> seeds);
+
+  void runBuckets(const std::vector<Seed>& seeds);
+
+  void runHeap(const std::vector<Seed>& seeds);
+
+  bool settle(Index vertex);
+
+  bool relax(Index from, Index to, int distance);
+
+  void discard(Index vertex);
+
+  const GraphType& _graph;
+
+  bool _withPredecessors = false;
+
+  bool _withLabels = false;
+
+  Limits _limits;
+
+  std::size_t _settledCount = 0;
+
+  std::vector<bool> _settled;
+
+  std::vector<int> _distances;
+
+  std::vector<Index> _predecessors;
+
+  std::vector<Index> _labels;
+};
+
+template<class GraphType>
+ShortestPaths<GraphType>::ShortestPaths(const GraphType& graph)
+  : _graph(graph)
+{
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::run(Index source, bool withPredecessors)
+{
+  _withPredecessors = withPredecessors;
+  _withLabels = false;
+  _limits = Limits();
+
+  search({ { source, 0 } });
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::run(const std::vector<Seed>& seeds,
+                              Limits limits,
+                              bool withPredecessors)
+{
+  _withPredecessors = withPredecessors;
+  _withLabels = true;
+  _limits = limits;
+
+  search(seeds);
+}
+
+template<class GraphType>
+const std::vector<int>&
+ShortestPaths<GraphType>::distances() const
+{
+  return _distances;
+}
+
+template<class GraphType>
+const std::vector<typename ShortestPaths<GraphType>::Index>&
+ShortestPaths<GraphType>::predecessors() const
+{
+  return _predecessors;
+}
+
+template<class GraphType>
+const std::vector<typename ShortestPaths<GraphType>::Index>&
+ShortestPaths<GraphType>::labels() const
+{
+  return _labels;
+}
+
+template<class GraphType>
+std::vector<int>
+ShortestPaths<GraphType>::takeDistances()
+{
+  return std::move(_distances);
+}
+
+template<class GraphType>
+std::vector<typename ShortestPaths<GraphType>::Index>
+ShortestPaths<GraphType>::takePredecessors()
+{
+  return std::move(_predecessors);
+}
+
+template<class GraphType>
+std::vector<typename ShortestPaths<GraphType>::Index>
+ShortestPaths<GraphType>::takeLabels()
+{
+  return std::move(_labels);
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::search(std::vector<Seed> seeds)
+{
+  _distances.assign(_graph.size(), Unreachable);
+  _predecessors.clear();
+  _labels.clear();
+  _settled.clear();
+  _settledCount = 0;
+
+  if (_withPredecessors) {
+    _predecessors.assign(_graph.size(), NoVertex);
+  }
+
+  if (_withLabels) {
+    _labels.assign(_graph.size(), NoVertex);
+  }
+
+  if (_limits.maxVertices != SIZE_MAX) {
+    _settled.assign(_graph.size(), false);
+  }
+
+  // seeds become the initial frontier in order of their offsets; a seed that
+  // is repeated keeps its smallest offset and the label of the seed that gave
+  // it, and is queued once
+  std::vector<Seed> frontier;
+  for (Index label = 0; label < seeds.size(); label += 1) {
+    auto& seed = seeds[label];
+
+    if (seed.vertex >= _graph.size() || seed.offset < 0 ||
+        seed.offset > _limits.maxDistance) {
+      continue;
+    }
+
+    if (seed.offset < _distances[seed.vertex]) {
+      _distances[seed.vertex] = seed.offset;
+
+      if (_withLabels) {
+        _labels[seed.vertex] = label;
+      }
+
+      frontier.push_back(seed);
+    }
+  }
+
+  // only the last push of a vertex carries its final offset
+  frontier.erase(
+    std::remove_if(frontier.begin(),
+                   frontier.end(),
+                   [&](const Seed& seed) {
+                     return seed.offset != _distances[seed.vertex];
+                   }),
+    frontier.end());
+
+  std::stable_sort(
+    frontier.begin(), frontier.end(), [](const Seed& l, const Seed& r) {
+      return l.offset < r.offset;
+    });
+
+  int maxWeight = _graph.maxWeight();
+  if (maxWeight >= 0 && maxWeight <= MaxBucketWeight) {
+    runBuckets(frontier);
+  } else {
+    runHeap(frontier);
+  }
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::runBuckets(const std::vector<Seed>& seeds)
+{
+  // distances of queued vertices span at most maxWeight + 1 values, so the
+  // buckets can be reused circularly; seeds are only queued once the search
+  // reaches their offset to keep that window intact
+  std::vector<std::vector<Index>> buckets(_graph.maxWeight() + 1);
+  std::size_t pending = 0;
+  std::size_t nextSeed = 0;
+  int current = 0;
+
+  while (pending > 0 || nextSeed < seeds.size()) {
+    if (pending == 0 && seeds[nextSeed].offset > current) {
+      current = seeds[nextSeed].offset;
+    }
+
+    while (nextSeed < seeds.size() && seeds[nextSeed].offset == current) {
+      buckets[current % buckets.size()].push_back(seeds[nextSeed].vertex);
+      pending += 1;
+      nextSeed += 1;
+    }
+
+    auto& bucket = buckets[current % buckets.size()];
+
+    while (!bucket.empty()) {
+      auto vertex = bucket.back();
+      bucket.pop_back();
+      pending -= 1;
+
+      if (_distances[vertex] != current) {
+        continue;
+      }
+
+      if (!settle(vertex)) {
+        discard(vertex);
+
+        for (auto& remaining : buckets) {
+          for (auto unsettled : remaining) {
+            discard(unsettled);
+          }
+        }
+
+        for (; nextSeed < seeds.size(); nextSeed += 1) {
+          discard(seeds[nextSeed].vertex);
+        }
+
+        return;
+      }
+
+      _graph.forEachNeighbor(vertex, [&](Index to, int w) {
+        if (relax(vertex, to, current + w)) {
+          buckets[(current + w) % buckets.size()].push_back(to);
+          pending += 1;
+        }
+      });
+    }
+
+    current += 1;
+  }
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::runHeap(const std::vector<Seed>& seeds)
+{
+  // relaxing a queued vertex lowers its key in place, so the queue never
+  // holds more than V entries
+  Heap<int, Index, std::less<int>, 4, DenseIndexPositions<Index>> unprocessed;
+
+  for (auto& seed : seeds) {
+    unprocessed.insert(seed.offset, seed.vertex);
+  }
+
+  while (!unprocessed.empty()) {
+    auto vertex = unprocessed.extractMin();
+    auto distance = _distances[vertex];
+
+    if (!settle(vertex)) {
+      discard(vertex);
+
+      while (!unprocessed.empty()) {
+        discard(unprocessed.extractMin());
+      }
+
+      return;
+    }
+
+    _graph.forEachNeighbor(vertex, [&](Index to, int w) {
+      if (relax(vertex, to, distance + w)) {
+        unprocessed.insert(distance + w, to);
+      }
+    });
+  }
+}
+
+template<class GraphType>
+bool
+ShortestPaths<GraphType>::settle(Index vertex)
+{
+  if (_settled.empty()) {
+    return true;
+  }
+
+  if (_settledCount == _limits.maxVertices) {
+    return false;
+  }
+
+  _settled[vertex] = true;
+  _settledCount += 1;
+
+  return true;
+}
+
+template<class GraphType>
+bool
+ShortestPaths<GraphType>::relax(Index from, Index to, int distance)
+{
+  if (distance >= _distances[to] || distance > _limits.maxDistance) {
+    return false;
+  }
+
+  _distances[to] = distance;
+
+  if (_withPredecessors) {
+    _predecessors[to] = from;
+  }
+
+  if (_withLabels) {
+    _labels[to] = _labels[from];
+  }
+
+  return true;
+}
+
+template<class GraphType>
+void
+ShortestPaths<GraphType>::discard(Index vertex)
+{
+  if (_settled[vertex]) {
+    return;
+  }
+
+  _distances[vertex] = Unreachable;
+
+  if (_withPredecessors) {
+    _predecessors[vertex] = NoVertex;
+  }
+
+  if (_withLabels) {
+    _labels[vertex] = NoVertex;
+  }
+}
+
+#endif // ShortestPaths.h included
@@ -0,0 +1,184 @@
+#ifndef SORTED_VECTOR_MAP_H_
+#define SORTED_VECTOR_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// A map kept as one vector of key/value pairs sorted by key. Lookups are a
+// binary search over contiguous memory and inserts shift the tail, which
+// beats a tree while the map stays small, as the neighbor lists of bounded
+// degree graphs do.
+template<class KeyType, class ValueType>
+class SortedVectorMap
+{
+public:
+  using value_type = std::pair<KeyType, ValueType>;
+
+  using iterator = typename std::vector<value_type>::iterator;
+
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  SortedVectorMap();
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  void clear();
+
+  iterator begin();
+
+  iterator end();
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  iterator find(const KeyType& key);
+
+  const_iterator find(const KeyType& key) const;
+
+  std::pair<iterator, bool> insert(const value_type& value);
+
+  ValueType& operator[](const KeyType& key);
+
+  std::size_t erase(const KeyType& key);
+
+private:
+  iterator lowerBound(const KeyType& key);
+
+  const_iterator lowerBound(const KeyType& key) const;
+
+  std::vector<value_type> _entries;
+};
+
+template<class KeyType, class ValueType>
+SortedVectorMap<KeyType, ValueType>::SortedVectorMap()
+{
+}
+
+template<class KeyType, class ValueType>
+std::size_t
+SortedVectorMap<KeyType, ValueType>::size() const
+{
+  return _entries.size();
+}
+
+template<class KeyType, class ValueType>
+bool
+SortedVectorMap<KeyType, ValueType>::empty() const
+{
+  return _entries.empty();
+}
+
+template<class KeyType, class ValueType>
+void
+SortedVectorMap<KeyType, ValueType>::clear()
+{
+  _entries.clear();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::iterator
+SortedVectorMap<KeyType, ValueType>::begin()
+{
+  return _entries.begin();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::iterator
+SortedVectorMap<KeyType, ValueType>::end()
+{
+  return _entries.end();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::const_iterator
+SortedVectorMap<KeyType, ValueType>::begin() const
+{
+  return _entries.begin();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::const_iterator
+SortedVectorMap<KeyType, ValueType>::end() const
+{
+  return _entries.end();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::iterator
+SortedVectorMap<KeyType, ValueType>::find(const KeyType& key)
+{
+  auto it = lowerBound(key);
+
+  return it != _entries.end() && !(key < it->first) ? it : _entries.end();
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::const_iterator
+SortedVectorMap<KeyType, ValueType>::find(const KeyType& key) const
+{
+  auto it = lowerBound(key);
+
+  return it != _entries.end() && !(key < it->first) ? it : _entries.end();
+}
+
+template<class KeyType, class ValueType>
+std::pair<typename SortedVectorMap<KeyType, ValueType>::iterator, bool>
+SortedVectorMap<KeyType, ValueType>::insert(const value_type& value)
+{
+  auto it = lowerBound(value.first);
+
+  if (it != _entries.end() && !(value.first < it->first)) {
+    return { it, false };
+  }
+
+  return { _entries.insert(it, value), true };
+}
+
+template<class KeyType, class ValueType>
+ValueType&
+SortedVectorMap<KeyType, ValueType>::operator[](const KeyType& key)
+{
+  return insert({ key, ValueType() }).first->second;
+}
+
+template<class KeyType, class ValueType>
+std::size_t
+SortedVectorMap<KeyType, ValueType>::erase(const KeyType& key)
+{
+  auto it = find(key);
+
+  if (it == _entries.end()) {
+    return 0;
+  }
+
+  _entries.erase(it);
+
+  return 1;
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::iterator
+SortedVectorMap<KeyType, ValueType>::lowerBound(const KeyType& key)
+{
+  return std::lower_bound(
+    _entries.begin(), _entries.end(), key, [](const auto& entry, auto& k) {
+      return entry.first < k;
+    });
+}
+
+template<class KeyType, class ValueType>
+typename SortedVectorMap<KeyType, ValueType>::const_iterator
+SortedVectorMap<KeyType, ValueType>::lowerBound(const KeyType& key) const
+{
+  return std::lower_bound(
+    _entries.begin(), _entries.end(), key, [](const auto& entry, auto& k) {
+      return entry.first < k;
+    });
+}
+
+#endif // SortedVectorMap.h included
@@ -0,0 +1,222 @@
+#ifndef SPANNING_FOREST_H_
+#define SPANNING_FOREST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "../util/Parallel.h"
+#include "ConcurrentUnionFind.h"
+#include "EdgeList.h"
+#include "UnionFind.h"
+
+// Minimum spanning forest of the undirected edges of an index graph (see
+// undirectedEdges). run() is a parallel Boruvka: each round every component
+// finds its cheapest outgoing edge with an atomic minimum, the chosen edges
+// are linked in a ConcurrentUnionFind, and edges inside a component are
+// dropped. runKruskal() is the serial reference. Ties are broken by edge
+// order, so both pick the same forest, which is stored sorted by weight,
+// then endpoints.
+template<class GraphType>
+class SpanningForest
+{
+public:
+  using Index = std::uint32_t;
+
+  SpanningForest(const GraphType& graph, WorkerPool& pool);
+
+  void run();
+
+  void runKruskal();
+
+  const std::vector<WeightedEdge>& edges() const;
+
+  std::vector<WeightedEdge> takeEdges();
+
+  long long weight() const;
+
+private:
+  static constexpr std::uint64_t NoKey = UINT64_MAX;
+
+  static std::uint64_t key(const WeightedEdge& edge, std::size_t index);
+
+  void sortForest();
+
+  const GraphType& _graph;
+
+  WorkerPool& _pool;
+
+  std::vector<WeightedEdge> _forest;
+};
+
+template<class GraphType>
+SpanningForest<GraphType>::SpanningForest(const GraphType& graph,
+                                          WorkerPool& pool)
+  : _graph(graph)
+  , _pool(pool)
+{
+}
+
+template<class GraphType>
+void
+SpanningForest<GraphType>::run()
+{
+  auto edges = undirectedEdges(_graph, _pool);
+  std::size_t size = _graph.size();
+
+  ConcurrentUnionFind<Index> sets(size);
+  std::vector<std::atomic<std::uint64_t>> cheapest(size);
+  std::vector<std::vector<WeightedEdge>> linked(_pool.size());
+  std::vector<std::vector<WeightedEdge>> kept(_pool.size());
+
+  _pool.parallelFor(size, [&](int, std::size_t begin, std::size_t end) {
+    for (auto v = begin; v < end; v += 1) {
+      cheapest[v].store(NoKey, std::memory_order_relaxed);
+    }
+  });
+
+  while (!edges.empty()) {
+    _pool.parallelFor(
+      edges.size(), [&](int, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i += 1) {
+          auto from = sets.find(edges[i].from);
+          auto to = sets.find(edges[i].to);
+
+          if (from == to) {
+            continue;
+          }
+
+          auto k = key(edges[i], i);
+
+          for (auto leader : { from, to }) {
+            auto current = cheapest[leader].load(std::memory_order_relaxed);
+
+            while (k < current && !cheapest[leader].compare_exchange_weak(
+                                    current, k, std::memory_order_relaxed)) {
+            }
+          }
+        }
+      });
+
+    // an edge chosen by both of its components is linked only once
+    _pool.parallelFor(
+      size, [&](int worker, std::size_t begin, std::size_t end) {
+        for (auto v = begin; v < end; v += 1) {
+          auto k = cheapest[v].load(std::memory_order_relaxed);
+
+          if (k == NoKey) {
+            continue;
+          }
+
+          cheapest[v].store(NoKey, std::memory_order_relaxed);
+
+          auto& edge = edges[static_cast<std::uint32_t>(k)];
+          if (sets.unionVertices(edge.from, edge.to)) {
+            linked[worker].push_back(edge);
+          }
+        }
+      });
+
+    _pool.parallelFor(
+      edges.size(), [&](int worker, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i += 1) {
+          if (sets.find(edges[i].from) != sets.find(edges[i].to)) {
+            kept[worker].push_back(edges[i]);
+          }
+        }
+      });
+
+    // workers keep contiguous slices, so edge order and ties survive
+    edges.clear();
+    for (auto& part : kept) {
+      edges.insert(edges.end(), part.begin(), part.end());
+      part.clear();
+    }
+  }
+
+  _forest.clear();
+  for (auto& part : linked) {
+    _forest.insert(_forest.end(), part.begin(), part.end());
+  }
+
+  sortForest();
+}
+
+template<class GraphType>
+void
+SpanningForest<GraphType>::runKruskal()
+{
+  auto edges = undirectedEdges(_graph, _pool);
+
+  std::stable_sort(
+    edges.begin(), edges.end(), [](const auto& e1, const auto& e2) {
+      return e1.weight < e2.weight;
+    });
+
+  DenseUnionFind<Index> sets(_graph.size());
+  _forest.clear();
+
+  for (auto& edge : edges) {
+    if (sets.unionVertices(edge.from, edge.to)) {
+      _forest.push_back(edge);
+    }
+  }
+
+  sortForest();
+}
+
+template<class GraphType>
+const std::vector<WeightedEdge>&
+SpanningForest<GraphType>::edges() const
+{
+  return _forest;
+}
+
+template<class GraphType>
+std::vector<WeightedEdge>
+SpanningForest<GraphType>::takeEdges()
+{
+  return std::move(_forest);
+}
+
+template<class GraphType>
+long long
+SpanningForest<GraphType>::weight() const
+{
+  long long total = 0;
+
+  for (auto& edge : _forest) {
+    total += edge.weight;
+  }
+
+  return total;
+}
+
+// orders edges by weight, then position; the sign bit is flipped so that
+// negative weights compare below positive ones
+template<class GraphType>
+std::uint64_t
+SpanningForest<GraphType>::key(const WeightedEdge& edge, std::size_t index)
+{
+  auto weight = static_cast<std::uint32_t>(edge.weight) ^ 0x80000000u;
+
+  return (static_cast<std::uint64_t>(weight) << 32) |
+         static_cast<std::uint32_t>(index);
+}
+
+template<class GraphType>
+void
+SpanningForest<GraphType>::sortForest()
+{
+  std::sort(
+    _forest.begin(), _forest.end(), [](const auto& e1, const auto& e2) {
+      if (e1.weight != e2.weight) {
+        return e1.weight < e2.weight;
+      }
+
+      return e1.from != e2.from ? e1.from < e2.from : e1.to < e2.to;
+    });
+}
+
+#endif // SpanningForest.h included
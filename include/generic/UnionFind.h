@@ -1,89 +1,242 @@
 #ifndef UNION_FIND_H_
 #define UNION_FIND_H_
 
+#include <cstdint>
 #include <map>
+#include <utility>
 #include <vector>
 
+// Disjoint sets over the integers [0, size()), with union by size and
+// iterative path halving
+template<class IndexType = std::uint32_t>
+class DenseUnionFind
+{
+public:
+  DenseUnionFind();
+
+  explicit DenseUnionFind(std::size_t size);
+
+  void reset(std::size_t size);
+
+  IndexType insert();
+
+  std::size_t size() const;
+
+  std::size_t components() const;
+
+  IndexType find(IndexType vertex);
+
+  bool unionVertices(IndexType v1, IndexType v2);
+
+  IndexType componentSize(IndexType vertex);
+
+  std::vector<IndexType> flatten();
+
+  void clear();
+
+private:
+  std::vector<IndexType> _parent;
+
+  std::vector<IndexType> _size;
+
+  std::size_t _components = 0;
+};
+
+// Disjoint sets over arbitrary ordered vertices, numbered on insertion and
+// backed by a DenseUnionFind
 template<class VertexType>
 class UnionFind
 {
 public:
   void insert(const VertexType& vertex);
 
-  VertexType find(VertexType& vertex);
+  VertexType find(const VertexType& vertex);
+
+  void unionVertices(const VertexType& v1, const VertexType& v2);
 
-  void unionVertices(VertexType v1, VertexType v2);
+  std::size_t componentSize(const VertexType& vertex);
 
   void clear();
 
 private:
-  VertexType& findHelper(VertexType& vertex);
+  std::uint32_t indexOf(const VertexType& vertex);
 
-  std::map<VertexType, VertexType> _leaderMap;
+  std::map<VertexType, std::uint32_t> _indices;
 
-  std::map<VertexType, int> _rank;
+  std::vector<VertexType> _vertices;
+
+  DenseUnionFind<std::uint32_t> _sets;
 };
 
-template<class VertexType>
-void
-UnionFind<VertexType>::insert(const VertexType& vertex)
+template<class IndexType>
+DenseUnionFind<IndexType>::DenseUnionFind()
 {
-  _leaderMap.insert(std::make_pair(vertex, vertex));
-  _rank.insert(std::make_pair(vertex, 0));
 }
 
-template<class VertexType>
-VertexType
-UnionFind<VertexType>::find(VertexType& vertex)
+template<class IndexType>
+DenseUnionFind<IndexType>::DenseUnionFind(std::size_t size)
 {
-  auto leader = findHelper(vertex);
+  reset(size);
+}
 
-  auto toCompress = std::vector<VertexType>();
-  auto temp = vertex;
-  while (_leaderMap[temp] != leader) {
-    toCompress.push_back(temp);
-    temp = _leaderMap[temp];
+template<class IndexType>
+void
+DenseUnionFind<IndexType>::reset(std::size_t size)
+{
+  _parent.resize(size);
+  _size.assign(size, 1);
+  _components = size;
+
+  for (std::size_t v = 0; v < size; v += 1) {
+    _parent[v] = v;
   }
-  for (auto& compress : toCompress) {
-    _leaderMap[compress] = leader;
+}
+
+template<class IndexType>
+IndexType
+DenseUnionFind<IndexType>::insert()
+{
+  IndexType vertex = _parent.size();
+
+  _parent.push_back(vertex);
+  _size.push_back(1);
+  _components += 1;
+
+  return vertex;
+}
+
+template<class IndexType>
+std::size_t
+DenseUnionFind<IndexType>::size() const
+{
+  return _parent.size();
+}
+
+template<class IndexType>
+std::size_t
+DenseUnionFind<IndexType>::components() const
+{
+  return _components;
+}
+
+template<class IndexType>
+IndexType
+DenseUnionFind<IndexType>::find(IndexType vertex)
+{
+  while (_parent[vertex] != vertex) {
+    _parent[vertex] = _parent[_parent[vertex]];
+    vertex = _parent[vertex];
   }
 
-  return leader;
+  return vertex;
 }
 
-template<class VertexType>
-void
-UnionFind<VertexType>::unionVertices(VertexType v1, VertexType v2)
+template<class IndexType>
+bool
+DenseUnionFind<IndexType>::unionVertices(IndexType v1, IndexType v2)
 {
   auto leader1 = find(v1);
   auto leader2 = find(v2);
-  if (_rank[leader1] < _rank[leader2]) {
-    _leaderMap[leader1] = _leaderMap[leader2];
-  } else if (_rank[leader1] == _rank[leader2]) {
-    _leaderMap[leader1] = _leaderMap[leader2];
-    _rank[leader2] += 1;
-  } else {
-    _leaderMap[leader2] = _leaderMap[leader1];
+
+  if (leader1 == leader2) {
+    return false;
   }
+
+  if (_size[leader1] < _size[leader2]) {
+    std::swap(leader1, leader2);
+  }
+
+  _parent[leader2] = leader1;
+  _size[leader1] += _size[leader2];
+  _components -= 1;
+
+  return true;
 }
 
-template<class VertexType>
-VertexType&
-UnionFind<VertexType>::findHelper(VertexType& vertex)
+template<class IndexType>
+IndexType
+DenseUnionFind<IndexType>::componentSize(IndexType vertex)
+{
+  return _size[find(vertex)];
+}
+
+template<class IndexType>
+std::vector<IndexType>
+DenseUnionFind<IndexType>::flatten()
 {
-  if (vertex == _leaderMap[vertex]) {
-    return vertex;
+  std::vector<IndexType> labels(_parent.size());
+
+  // also points every vertex straight at its leader for later finds
+  for (std::size_t v = 0; v < _parent.size(); v += 1) {
+    labels[v] = find(v);
+    _parent[v] = labels[v];
   }
 
-  return findHelper(_leaderMap[vertex]);
+  return labels;
+}
+
+template<class IndexType>
+void
+DenseUnionFind<IndexType>::clear()
+{
+  _parent.clear();
+  _size.clear();
+  _components = 0;
+}
+
+template<class VertexType>
+void
+UnionFind<VertexType>::insert(const VertexType& vertex)
+{
+  indexOf(vertex);
+}
+
+template<class VertexType>
+VertexType
+UnionFind<VertexType>::find(const VertexType& vertex)
+{
+  return _vertices[_sets.find(indexOf(vertex))];
+}
+
+template<class VertexType>
+void
+UnionFind<VertexType>::unionVertices(const VertexType& v1,
+                                     const VertexType& v2)
+{
+  _sets.unionVertices(indexOf(v1), indexOf(v2));
+}
+
+template<class VertexType>
+std::size_t
+UnionFind<VertexType>::componentSize(const VertexType& vertex)
+{
+  return _sets.componentSize(indexOf(vertex));
 }
 
 template<class VertexType>
 void
 UnionFind<VertexType>::clear()
 {
-  _leaderMap.clear();
-  _rank.clear();
+  _indices.clear();
+  _vertices.clear();
+  _sets.clear();
+}
+
+template<class VertexType>
+std::uint32_t
+UnionFind<VertexType>::indexOf(const VertexType& vertex)
+{
+  auto found = _indices.find(vertex);
+
+  if (found != _indices.end()) {
+    return found->second;
+  }
+
+  auto index = _sets.insert();
+  _indices.insert({ vertex, index });
+  _vertices.push_back(vertex);
+
+  return index;
 }
 
 #endif // UnionFind.h included
@@ -0,0 +1,43 @@
+#ifndef EDGE_WEIGHTS_H_
+#define EDGE_WEIGHTS_H_
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "../util/Neighborhood.h"
+#include "GridGraph.h"
+
+namespace gp {
+// How an edge between two neighboring pixels is weighed: the L1 or rounded
+// L2 distance between their 8-bit colors, the difference of their luma, or
+// a uniform draw from [0, 10) keyed by the edge
+enum class WeightMetric
+{
+  L1,
+  L2,
+  Luma,
+  Random
+};
+
+// Rounded Euclidean length of the channel differences of two 8-bit, three
+// channel colors, in [0, 442]; the L2 metric, which segmentImage weighs its
+// edges by as well
+int
+colorDistanceL2(int d0, int d1, int d2);
+
+// Weighs every lattice edge of nbr leaving a pixel of region, writing each
+// of those directions' weight planes of grid row by row. colors must be an
+// 8-bit, three channel image the size of the grid; seed only matters for
+// Random.
+void
+weighEdges(const cv::Mat& colors,
+           Neighborhood nbr,
+           WeightMetric metric,
+           std::uint64_t seed,
+           cv::Rect region,
+           GridGraph& grid,
+           int threads = 0);
+} // namespace gp
+
+#endif // EdgeWeights.h included
@@ -0,0 +1,114 @@
+#ifndef GRAPH_FILE_H_
+#define GRAPH_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "../util/Neighborhood.h"
+#include "GridGraph.h"
+
+namespace gp {
+// A pixel graph on disk: this header, then three sections, each starting on
+// a 64 byte boundary and stored in native byte order: the 8-bit three
+// channel colors row by row, one GridGraph weight plane per direction, and
+// one union-find leader per pixel. The lattice makes the adjacency
+// implicit, so the weight planes are the whole CSR form of the graph.
+struct GraphFileHeader
+{
+  static constexpr std::uint32_t CurrentVersion = 1;
+
+  static constexpr std::uint32_t ByteOrder = 0x01020304;
+
+  char magic[8];
+
+  std::uint32_t version;
+
+  std::uint32_t byteOrder;
+
+  std::uint32_t headerSize;
+
+  std::int32_t width;
+
+  std::int32_t height;
+
+  std::uint32_t neighborhood;
+
+  std::uint32_t directions;
+
+  std::uint32_t maxWeight;
+
+  std::uint64_t colorsOffset;
+
+  std::uint64_t weightsOffset;
+
+  std::uint64_t labelsOffset;
+
+  std::uint64_t fileSize;
+};
+
+bool
+writeGraphFile(const std::string& path,
+               const cv::Mat& colors,
+               const GridGraph& grid,
+               const std::vector<std::uint32_t>& labels);
+
+// A graph file mapped read-only into memory. Opening checks the header and
+// the section bounds and reads nothing else; the accessors point straight
+// into the mapping, which the pages of the file back on demand and which
+// other processes opening the same file share.
+class GraphFile
+{
+public:
+  GraphFile();
+
+  ~GraphFile();
+
+  GraphFile(const GraphFile& other) = delete;
+
+  GraphFile& operator=(const GraphFile& other) = delete;
+
+  GraphFile(GraphFile&& other) noexcept;
+
+  GraphFile& operator=(GraphFile&& other) noexcept;
+
+  bool open(const std::string& path);
+
+  void close();
+
+  bool isOpen() const;
+
+  const GraphFileHeader& header() const;
+
+  int width() const;
+
+  int height() const;
+
+  Neighborhood neighborhood() const;
+
+  int directions() const;
+
+  GridGraph::Index size() const;
+
+  const cv::Mat& colors() const;
+
+  const GridGraph::Weight* weightPlane(int dir) const;
+
+  const std::uint32_t* labels() const;
+
+private:
+  bool valid() const;
+
+  const unsigned char* _data = nullptr;
+
+  std::size_t _size = 0;
+
+  // wraps the mapped colors without copying; writing through it faults
+  cv::Mat _colors;
+};
+} // namespace gp
+
+#endif // GraphFile.h included
@@ -0,0 +1,166 @@
+#ifndef GRID_GRAPH_H_
+#define GRID_GRAPH_H_
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <type_traits>
+#include <vector>
+
+#include "../util/Neighborhood.h"
+
+// A directed pixel lattice whose topology is implied by the Neighborhood.
+// Vertices are row-major pixel indices and every direction of the
+// neighborhood owns one dense weight plane, where NoEdge marks a missing edge.
+class GridGraph
+{
+public:
+  using Index = std::uint32_t;
+
+  using Weight = std::uint16_t;
+
+  static constexpr Index NoVertex = UINT32_MAX;
+
+  static constexpr Weight NoEdge = UINT16_MAX;
+
+  GridGraph();
+
+  GridGraph(int width, int height, Neighborhood nbr);
+
+  void reset(int width, int height, Neighborhood nbr);
+
+  void widen(Neighborhood nbr);
+
+  void clear();
+
+  int width() const;
+
+  int height() const;
+
+  Neighborhood neighborhood() const;
+
+  Index size() const;
+
+  int directions() const;
+
+  cv::Point2i direction(int dir) const;
+
+  int opposite(int dir) const;
+
+  int directionTo(Index from, Index to) const;
+
+  Index index(int x, int y) const;
+
+  Index index(cv::Point2i point) const;
+
+  cv::Point2i point(Index v) const;
+
+  Index neighbor(Index v, int dir) const;
+
+  bool hasEdge(Index v, int dir) const;
+
+  bool hasEdge(Index from, Index to) const;
+
+  bool hasEdges(Index v) const;
+
+  Weight weight(Index v, int dir) const;
+
+  Weight weight(Index from, Index to) const;
+
+  Weight maxWeight() const;
+
+  void setWeight(Index v, int dir, Weight weight);
+
+  void removeEdge(Index v, int dir);
+
+  void raiseMaxWeight(Weight weight);
+
+  std::vector<Weight>& weightPlane(int dir);
+
+  const std::vector<Weight>& weightPlane(int dir) const;
+
+  template<class Fn>
+  void forEachNeighbor(Index v, Fn fn) const;
+
+  bool hasReverseIndex() const;
+
+  template<class Fn>
+  void forEachInNeighbor(Index v, Fn fn) const;
+
+  std::vector<Index> bfs(int x, int y) const;
+
+  std::vector<int> djikstraKey(int x, int y) const;
+
+private:
+  int _width = 0;
+
+  int _height = 0;
+
+  Neighborhood _nbr = Neighborhood::Neumann;
+
+  std::vector<cv::Point2i> _directions;
+
+  std::vector<std::vector<Weight>> _weights;
+
+  Weight _maxWeight = 0;
+};
+
+template<class Fn>
+void
+GridGraph::forEachNeighbor(Index v, Fn fn) const
+{
+  int x = v % _width;
+  int y = v / _width;
+
+  for (int dir = 0; dir < directions(); dir += 1) {
+    auto w = _weights[dir][v];
+
+    if (w == NoEdge) {
+      continue;
+    }
+
+    int nx = x + _directions[dir].x;
+    int ny = y + _directions[dir].y;
+
+    if (nx >= 0 && ny >= 0 && nx < _width && ny < _height) {
+      fn(static_cast<Index>(ny) * _width + nx, w);
+    }
+  }
+}
+
+// The edge into v from its neighbor in direction dir is stored by that
+// neighbor, in the plane of the opposite direction. If fn returns bool,
+// false stops the walk.
+template<class Fn>
+void
+GridGraph::forEachInNeighbor(Index v, Fn fn) const
+{
+  int x = v % _width;
+  int y = v / _width;
+
+  for (int dir = 0; dir < directions(); dir += 1) {
+    int nx = x + _directions[dir].x;
+    int ny = y + _directions[dir].y;
+
+    if (nx < 0 || ny < 0 || nx >= _width || ny >= _height) {
+      continue;
+    }
+
+    Index from = static_cast<Index>(ny) * _width + nx;
+    auto w = _weights[opposite(dir)][from];
+
+    if (w == NoEdge) {
+      continue;
+    }
+
+    if constexpr (std::is_same<decltype(fn(from, w)), bool>::value) {
+      if (!fn(from, w)) {
+        return;
+      }
+    } else {
+      fn(from, w);
+    }
+  }
+}
+
+#endif // GridGraph.h included
@@ -3,9 +3,11 @@
 
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 #include "../generic/Graph.h"
 #include "../util/Neighborhood.h"
@@ -69,6 +71,14 @@ spherical(std::vector<cv::Vec3b>& colors);
 int
 compareIntensity(cv::Vec3b l, cv::Vec3b r);
 
+// The k brightest pixels of an 8-bit three channel image as row-major
+// indices, brightest first, by the channel sum compareIntensity uses; ties
+// go to the lower index. Each worker streams its rows through a heap
+// bounded to k and the heaps are melded, so this is O(n log k) with no
+// sort of the image.
+std::vector<std::uint32_t>
+brightestPixels(const cv::Mat& image, std::size_t k, int threads = 0);
+
 void
 swapPixels(cv::Mat& image, cv::Point l, cv::Point r);
 
@@ -0,0 +1,27 @@
+#ifndef LABELING_H_
+#define LABELING_H_
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "../util/Neighborhood.h"
+#include "GridGraph.h"
+
+namespace gp {
+constexpr std::uint32_t NoLabel = UINT32_MAX;
+
+std::size_t
+labelComponents(const cv::Mat& mask,
+                Neighborhood nbr,
+                std::vector<std::uint32_t>& labels,
+                int threads = 0);
+
+std::size_t
+labelComponents(const GridGraph& graph,
+                std::vector<std::uint32_t>& labels,
+                int threads = 0);
+} // namespace gp
+
+#endif // Labeling.h included
@@ -0,0 +1,57 @@
+#ifndef PAINT_H_
+#define PAINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace gp {
+// A shader maps a distance and the leader's intensity (0 to 1) to the gain
+// applied to every channel of the leader's color
+using Shader =
+  std::function<float(int distance, int maxDistance, float intensity)>;
+
+float
+ringShader(int distance, int maxDistance, float intensity);
+
+// A shader evaluated once per distance bucket and intensity level, so
+// painting a pixel is a lookup and an 8.8 fixed point multiply per channel.
+// Distances up to distanceBuckets - 1 get a bucket each; longer ranges are
+// split into that many equal buckets, as weighted distances reach millions.
+class ShadeTable
+{
+public:
+  ShadeTable(const Shader& shader,
+             int maxDistance,
+             int intensityLevels = 64,
+             int distanceBuckets = 1024);
+
+  int maxDistance() const;
+
+  cv::Vec3b shade(cv::Vec3b color, int distance) const;
+
+private:
+  std::size_t bucket(int distance) const;
+
+  int _maxDistance;
+
+  int _levels;
+
+  int _buckets;
+
+  std::vector<std::uint16_t> _gains;
+};
+
+void
+paintLabels(const cv::Mat& colors,
+            const std::vector<int>& distances,
+            const std::vector<std::uint32_t>& labels,
+            const ShadeTable& table,
+            cv::Mat& canvas,
+            int threads = 0);
+} // namespace gp
+
+#endif // Paint.h included
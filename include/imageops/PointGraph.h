@@ -1,47 +1,112 @@
 #ifndef POINT_GRAPH_H_
 #define POINT_GRAPH_H_
 
+#include <cstdint>
 #include <map>
-#include <memory>
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
 
+#include "../generic/ConcurrentUnionFind.h"
 #include "../generic/Graph.h"
+#include "../generic/ShortestPaths.h"
+#include "../generic/SpanningForest.h"
 #include "../generic/UnionFind.h"
 #include "../util/Neighborhood.h"
+#include "../util/Philox.h"
+#include "EdgeWeights.h"
+#include "GridGraph.h"
+#include "Paint.h"
 #include "PointVertex.h"
 
-using Vertex = std::shared_ptr<PointVertex>;
+using Vertex = GridGraph::Index;
+
+using Seed = ShortestPathSeed;
 
 class PointGraph
 {
 public:
   PointGraph();
 
-  void paintImage(cv::Mat& canvas);
+  void paintImage(cv::Mat& canvas, const gp::Shader& shader = gp::ringShader);
 
   void addVerticesFromImage(cv::Mat& fromImage);
 
-  void connectAllNeighbors(int width, int height, Neighborhood nbr);
+  void connectAllNeighbors(int width,
+                           int height,
+                           Neighborhood nbr,
+                           gp::WeightMetric metric = gp::WeightMetric::Random,
+                           int threads = 0);
 
   void connectRandom(int maxEdges);
 
-  void unionChunk(int x, int y, int depth, Neighborhood n);
+  void connectRandom(int maxEdges, std::uint64_t seed, int threads = 0);
+
+  void unionChunk(int x, int y, int depth, Neighborhood n, std::uint64_t seed);
 
   void unionChunks(Neighborhood nbr, float vP);
 
-  std::map<Vertex, Vertex> djikstraPaths(int x, int y);
+  void unionChunks(Neighborhood nbr,
+                   float vP,
+                   std::uint64_t seed,
+                   int threads = 0);
+
+  std::size_t segment(Neighborhood nbr,
+                      float k,
+                      int minSize,
+                      int threads = 0);
+
+  std::vector<Vertex> djikstraPaths(int x, int y);
+
+  // threads == 1 runs the serial bucket search, any other count runs delta
+  // stepping on a pool of that many workers, 0 meaning the pool default;
+  // both give the same distances
+  std::vector<int> djikstraKey(int x, int y, int threads = 0);
+
+  void nearestSeeds(const std::vector<Seed>& seeds,
+                    std::vector<int>& distances,
+                    std::vector<Vertex>& labels,
+                    int maxDistance = INT_MAX,
+                    std::size_t maxVertices = SIZE_MAX);
+
+  void bfs(int x,
+           int y,
+           std::vector<Vertex>& order,
+           std::vector<int>& levels,
+           std::vector<Vertex>& parents) const;
+
+  // threads picks the serial or the direction-optimizing search as for
+  // djikstraKey
+  std::vector<int> bfsLevels(int x, int y, int threads = 0) const;
 
-  std::map<Vertex, int> djikstraKey(int x, int y);
+  std::vector<WeightedEdge> spanningForest(int threads = 0) const;
 
-  Graph<Vertex> bfs(int x, int y);
+  Graph<Vertex> subgraph(const std::vector<Vertex>& vertices) const;
+
+  Vertex index(int x, int y) const;
+
+  PointVertex vertex(Vertex v) const;
+
+  cv::Vec3b color(Vertex v) const;
+
+  GridGraph& grid();
+
+  bool save(const std::string& path);
+
+  bool load(const std::string& path);
 
 private:
-  Graph<Vertex> _pointGraph;
+  void unionWalk(Vertex start,
+                 int depth,
+                 const std::vector<cv::Point2i>& directions,
+                 const Philox& rng);
+
+  GridGraph _grid;
 
-  std::map<int, std::map<int, Vertex>> _pointMap;
+  cv::Mat _colors;
 
-  UnionFind<Vertex> _unionFind;
+  ConcurrentUnionFind<Vertex> _unionFind;
 
   cv::Point2i _bottomRight;
 };
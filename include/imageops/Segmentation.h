@@ -0,0 +1,29 @@
+#ifndef SEGMENTATION_H_
+#define SEGMENTATION_H_
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "../util/Neighborhood.h"
+
+namespace gp {
+// Graph-based segmentation (Felzenszwalb & Huttenlocher) of an 8-bit, three
+// channel image. Edges join lattice neighbors and weigh the rounded
+// Euclidean color distance, so they are bucket sorted in linear time. Two
+// regions merge when their connecting edge is no heavier than either
+// region's largest internal edge plus k / size; regions smaller than
+// minSize are then merged into their cheapest neighbor. Each label is the
+// index of its region's leader pixel, which is what paintLabels expects.
+// Returns the number of regions.
+std::size_t
+segmentImage(const cv::Mat& image,
+             Neighborhood nbr,
+             float k,
+             int minSize,
+             std::vector<std::uint32_t>& labels,
+             int threads = 0);
+} // namespace gp
+
+#endif // Segmentation.h included
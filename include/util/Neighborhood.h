@@ -19,4 +19,9 @@ neighbors(Neighborhood n,
           int rightBound,
           int upBound);
 
+// Unit offsets of a neighborhood; the Neumann offsets are always the first
+// four, so a Moore lattice extends a Neumann one
+std::vector<cv::Point>
+offsets(Neighborhood n);
+
 #endif // Neighborhood.h included
@@ -0,0 +1,79 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int
+defaultThreads();
+
+// A fixed set of threads that run the same task together. The calling thread
+// takes part as worker 0, and run() returns once every worker has finished,
+// so successive phases of an algorithm can reuse the threads cheaply.
+class WorkerPool
+{
+public:
+  explicit WorkerPool(int threads = 0);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  int size() const;
+
+  void run(const std::function<void(int)>& task);
+
+  template<class Fn>
+  void parallelFor(std::size_t count, Fn fn, std::size_t grain = 1024);
+
+private:
+  void work(int worker);
+
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+
+  std::condition_variable _start;
+
+  std::condition_variable _done;
+
+  const std::function<void(int)>* _task = nullptr;
+
+  std::size_t _generation = 0;
+
+  int _remaining = 0;
+
+  bool _stopping = false;
+};
+
+// Calls fn(worker, begin, end) on contiguous slices of [0, count); ranges
+// smaller than two grains run inline on the calling thread.
+template<class Fn>
+void
+WorkerPool::parallelFor(std::size_t count, Fn fn, std::size_t grain)
+{
+  if (size() == 1 || count < grain * 2) {
+    if (count > 0) {
+      fn(0, 0, count);
+    }
+    return;
+  }
+
+  std::size_t workers = size();
+  run([&](int worker) {
+    std::size_t begin = count * worker / workers;
+    std::size_t end = count * (worker + 1) / workers;
+
+    if (begin < end) {
+      fn(worker, begin, end);
+    }
+  });
+}
+
+#endif // Parallel.h included
@@ -0,0 +1,74 @@
+#ifndef PHILOX_H_
+#define PHILOX_H_
+
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Every draw is a pure function of the key and
+// a counter, so a decision keyed by, say, a pixel index and a step number is
+// the same on every run and on every thread.
+class Philox
+{
+public:
+  using Block = std::array<std::uint32_t, 4>;
+
+  explicit Philox(std::uint64_t seed);
+
+  Block operator()(std::uint64_t counter, std::uint32_t stream = 0) const;
+
+  std::uint32_t draw(std::uint64_t counter, std::uint32_t stream = 0) const;
+
+  float uniform(std::uint64_t counter, std::uint32_t stream = 0) const;
+
+private:
+  std::uint32_t _key0;
+
+  std::uint32_t _key1;
+};
+
+inline Philox::Philox(std::uint64_t seed)
+  : _key0(static_cast<std::uint32_t>(seed))
+  , _key1(static_cast<std::uint32_t>(seed >> 32))
+{
+}
+
+inline Philox::Block
+Philox::operator()(std::uint64_t counter, std::uint32_t stream) const
+{
+  Block block{ static_cast<std::uint32_t>(counter),
+               static_cast<std::uint32_t>(counter >> 32),
+               stream,
+               0 };
+  std::uint32_t key0 = _key0;
+  std::uint32_t key1 = _key1;
+
+  for (int round = 0; round < 10; round += 1) {
+    std::uint64_t product0 = 0xD2511F53ull * block[0];
+    std::uint64_t product1 = 0xCD9E8D57ull * block[2];
+
+    block = { static_cast<std::uint32_t>(product1 >> 32) ^ block[1] ^ key0,
+              static_cast<std::uint32_t>(product1),
+              static_cast<std::uint32_t>(product0 >> 32) ^ block[3] ^ key1,
+              static_cast<std::uint32_t>(product0) };
+
+    key0 += 0x9E3779B9;
+    key1 += 0xBB67AE85;
+  }
+
+  return block;
+}
+
+inline std::uint32_t
+Philox::draw(std::uint64_t counter, std::uint32_t stream) const
+{
+  return (*this)(counter, stream)[0];
+}
+
+inline float
+Philox::uniform(std::uint64_t counter, std::uint32_t stream) const
+{
+  return (draw(counter, stream) >> 8) * (1.f / 16777216.f);
+}
+
+#endif // Philox.h included
@@ -0,0 +1,178 @@
+#include "../../include/imageops/EdgeWeights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "../../include/util/Parallel.h"
+#include "../../include/util/Philox.h"
+
+namespace {
+using Index = GridGraph::Index;
+
+using Weight = GridGraph::Weight;
+
+// One row of each color channel
+struct Channels
+{
+  const unsigned char* c[3];
+};
+
+// Runs weigh(a, b, x, nx, v, dir) for every edge of nbr leaving region,
+// where v is pixel x of the row a and its neighbor is pixel nx of the row b.
+// The colors of the rows the region touches are split into planes first,
+// so the inner loop, which walks one row of one direction between
+// precomputed bounds, reads every channel with unit stride and is branch
+// free; GCC vectorizes it for the color metrics at -O3 (-fno-math-errno is
+// needed for the square root of L2).
+template<class Weigh>
+void
+sweep(const cv::Mat& colors,
+      Neighborhood nbr,
+      cv::Rect region,
+      GridGraph& grid,
+      int threads,
+      Weigh weigh)
+{
+  int width = grid.width();
+  int height = grid.height();
+  // the Neumann directions come first, so a wider grid keeps its extra
+  // planes untouched
+  int dirs = std::min<int>(offsets(nbr).size(), grid.directions());
+
+  region &= cv::Rect(0, 0, width, height);
+  if (region.width <= 0 || region.height <= 0) {
+    return;
+  }
+
+  int top = std::max(region.y - 1, 0);
+  int bottom = std::min(region.y + region.height + 1, height);
+  std::vector<cv::Mat> planes;
+  cv::split(colors(cv::Rect(0, top, width, bottom - top)), planes);
+
+  auto channels = [&](int y) {
+    return Channels{ { planes[0].ptr<unsigned char>(y - top),
+                       planes[1].ptr<unsigned char>(y - top),
+                       planes[2].ptr<unsigned char>(y - top) } };
+  };
+
+  WorkerPool pool(threads);
+  std::vector<Weight> maxima(pool.size(), 0);
+
+  pool.parallelFor(
+    region.height,
+    [&](int worker, std::size_t begin, std::size_t end) {
+      Weight bandMax = 0;
+
+      for (auto row = begin; row < end; row += 1) {
+        int y = region.y + static_cast<int>(row);
+        auto a = channels(y);
+
+        for (int dir = 0; dir < dirs; dir += 1) {
+          auto offset = grid.direction(dir);
+          int ny = y + offset.y;
+
+          if (ny < 0 || ny >= height) {
+            continue;
+          }
+
+          int xBegin = std::max(region.x, -offset.x);
+          int xEnd = std::min(region.x + region.width, width - offset.x);
+
+          auto b = channels(ny);
+          Index first = static_cast<Index>(y) * width;
+          auto out = grid.weightPlane(dir).data() + first;
+
+          for (int x = xBegin; x < xEnd; x += 1) {
+            Weight w = weigh(a, b, x, x + offset.x, first + x, dir);
+            out[x] = w;
+            bandMax = std::max(bandMax, w);
+          }
+        }
+      }
+
+      maxima[worker] = std::max(maxima[worker], bandMax);
+    },
+    16);
+
+  grid.raiseMaxWeight(*std::max_element(maxima.begin(), maxima.end()));
+}
+} // namespace
+
+int
+gp::colorDistanceL2(int d0, int d1, int d2)
+{
+  float squared = d0 * d0 + d1 * d1 + d2 * d2;
+
+  return static_cast<int>(std::sqrt(squared) + 0.5f);
+}
+
+void
+gp::weighEdges(const cv::Mat& colors,
+               Neighborhood nbr,
+               WeightMetric metric,
+               std::uint64_t seed,
+               cv::Rect region,
+               GridGraph& grid,
+               int threads)
+{
+  switch (metric) {
+    case WeightMetric::L1:
+      sweep(colors,
+            nbr,
+            region,
+            grid,
+            threads,
+            [](auto& a, auto& b, int x, int nx, Index, int) {
+              return static_cast<Weight>(std::abs(a.c[0][x] - b.c[0][nx]) +
+                                         std::abs(a.c[1][x] - b.c[1][nx]) +
+                                         std::abs(a.c[2][x] - b.c[2][nx]));
+            });
+      break;
+
+    case WeightMetric::L2:
+      sweep(colors,
+            nbr,
+            region,
+            grid,
+            threads,
+            [](auto& a, auto& b, int x, int nx, Index, int) {
+              return static_cast<Weight>(
+                gp::colorDistanceL2(a.c[0][x] - b.c[0][nx],
+                                    a.c[1][x] - b.c[1][nx],
+                                    a.c[2][x] - b.c[2][nx]));
+            });
+      break;
+
+    case WeightMetric::Luma:
+      // BT.601 luma in 8.8 fixed point; channels are stored BGR
+      sweep(colors,
+            nbr,
+            region,
+            grid,
+            threads,
+            [](auto& a, auto& b, int x, int nx, Index, int) {
+              int lumaA = 29 * a.c[0][x] + 150 * a.c[1][x] + 77 * a.c[2][x];
+              int lumaB = 29 * b.c[0][nx] + 150 * b.c[1][nx] + 77 * b.c[2][nx];
+
+              return static_cast<Weight>((std::abs(lumaA - lumaB) + 128) >>
+                                         8);
+            });
+      break;
+
+    case WeightMetric::Random: {
+      Philox rng(seed);
+
+      sweep(colors,
+            nbr,
+            region,
+            grid,
+            threads,
+            [&](auto&, auto&, int, int, Index v, int dir) {
+              return static_cast<Weight>(rng.draw(v, dir) % 10);
+            });
+      break;
+    }
+  }
+}
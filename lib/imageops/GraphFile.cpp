@@ -0,0 +1,280 @@
+#include "../../include/imageops/GraphFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+const char Magic[8] = { 'G', 'P', 'G', 'R', 'A', 'P', 'H', '\0' };
+
+constexpr std::uint64_t Alignment = 64;
+
+std::uint64_t
+aligned(std::uint64_t offset)
+{
+  return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+void
+pad(std::ofstream& out, std::uint64_t offset)
+{
+  static const char zeros[Alignment] = {};
+
+  auto at = static_cast<std::uint64_t>(out.tellp());
+  out.write(zeros, offset - at);
+}
+} // namespace
+
+// Writes to a temporary file and renames it over path, so a process that
+// still maps the old file keeps a consistent view of it
+bool
+gp::writeGraphFile(const std::string& path,
+                   const cv::Mat& colors,
+                   const GridGraph& grid,
+                   const std::vector<std::uint32_t>& labels)
+{
+  std::uint64_t pixels = grid.size();
+
+  if (colors.type() != CV_8UC3 || colors.cols != grid.width() ||
+      colors.rows != grid.height() || labels.size() != pixels) {
+    return false;
+  }
+
+  GraphFileHeader header = {};
+  std::memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = GraphFileHeader::CurrentVersion;
+  header.byteOrder = GraphFileHeader::ByteOrder;
+  header.headerSize = sizeof(GraphFileHeader);
+  header.width = grid.width();
+  header.height = grid.height();
+  header.neighborhood = grid.neighborhood();
+  header.directions = grid.directions();
+  header.maxWeight = grid.maxWeight();
+  header.colorsOffset = aligned(sizeof(GraphFileHeader));
+  header.weightsOffset = aligned(header.colorsOffset + pixels * 3);
+  header.labelsOffset = aligned(header.weightsOffset +
+                                header.directions * pixels *
+                                  sizeof(GridGraph::Weight));
+  header.fileSize = header.labelsOffset + pixels * sizeof(std::uint32_t);
+
+  auto temporary = path + ".tmp";
+  std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  pad(out, header.colorsOffset);
+  for (int y = 0; y < colors.rows; y += 1) {
+    out.write(colors.ptr<char>(y), colors.cols * 3);
+  }
+
+  pad(out, header.weightsOffset);
+  for (int dir = 0; dir < grid.directions(); dir += 1) {
+    auto& plane = grid.weightPlane(dir);
+    out.write(reinterpret_cast<const char*>(plane.data()),
+              plane.size() * sizeof(GridGraph::Weight));
+  }
+
+  pad(out, header.labelsOffset);
+  out.write(reinterpret_cast<const char*>(labels.data()),
+            labels.size() * sizeof(std::uint32_t));
+
+  out.close();
+
+  if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+gp::GraphFile::GraphFile() {}
+
+gp::GraphFile::~GraphFile()
+{
+  close();
+}
+
+gp::GraphFile::GraphFile(GraphFile&& other) noexcept
+  : _data(std::exchange(other._data, nullptr))
+  , _size(std::exchange(other._size, 0))
+  , _colors(std::move(other._colors))
+{
+}
+
+gp::GraphFile&
+gp::GraphFile::operator=(GraphFile&& other) noexcept
+{
+  if (this != &other) {
+    close();
+
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _colors = std::move(other._colors);
+  }
+
+  return *this;
+}
+
+bool
+gp::GraphFile::open(const std::string& path)
+{
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size < 1) {
+    ::close(fd);
+    return false;
+  }
+
+  _size = status.st_size;
+  auto data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+
+  // the mapping holds its own reference to the file
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    _size = 0;
+    return false;
+  }
+
+  _data = static_cast<const unsigned char*>(data);
+
+  if (!valid()) {
+    close();
+    return false;
+  }
+
+  // cv::Mat wants a mutable pointer, but the pages are mapped read-only
+  _colors = cv::Mat(height(),
+                    width(),
+                    CV_8UC3,
+                    const_cast<unsigned char*>(_data) + header().colorsOffset);
+
+  return true;
+}
+
+void
+gp::GraphFile::close()
+{
+  _colors = cv::Mat();
+
+  if (_data != nullptr) {
+    munmap(const_cast<unsigned char*>(_data), _size);
+  }
+
+  _data = nullptr;
+  _size = 0;
+}
+
+bool
+gp::GraphFile::isOpen() const
+{
+  return _data != nullptr;
+}
+
+const gp::GraphFileHeader&
+gp::GraphFile::header() const
+{
+  return *reinterpret_cast<const GraphFileHeader*>(_data);
+}
+
+int
+gp::GraphFile::width() const
+{
+  return header().width;
+}
+
+int
+gp::GraphFile::height() const
+{
+  return header().height;
+}
+
+Neighborhood
+gp::GraphFile::neighborhood() const
+{
+  return static_cast<Neighborhood>(header().neighborhood);
+}
+
+int
+gp::GraphFile::directions() const
+{
+  return header().directions;
+}
+
+GridGraph::Index
+gp::GraphFile::size() const
+{
+  return static_cast<GridGraph::Index>(width()) * height();
+}
+
+const cv::Mat&
+gp::GraphFile::colors() const
+{
+  return _colors;
+}
+
+const GridGraph::Weight*
+gp::GraphFile::weightPlane(int dir) const
+{
+  return reinterpret_cast<const GridGraph::Weight*>(
+           _data + header().weightsOffset) +
+         static_cast<std::size_t>(dir) * size();
+}
+
+const std::uint32_t*
+gp::GraphFile::labels() const
+{
+  return reinterpret_cast<const std::uint32_t*>(_data +
+                                                header().labelsOffset);
+}
+
+// Checks everything the accessors rely on, so a truncated or foreign file
+// is refused instead of read out of bounds
+bool
+gp::GraphFile::valid() const
+{
+  if (_size < sizeof(GraphFileHeader)) {
+    return false;
+  }
+
+  auto& h = header();
+
+  if (std::memcmp(h.magic, Magic, sizeof(Magic)) != 0 ||
+      h.version != GraphFileHeader::CurrentVersion ||
+      h.byteOrder != GraphFileHeader::ByteOrder ||
+      h.headerSize != sizeof(GraphFileHeader) || h.width < 0 ||
+      h.height < 0 ||
+      (h.neighborhood != Moore && h.neighborhood != Neumann) ||
+      h.directions != offsets(neighborhood()).size()) {
+    return false;
+  }
+
+  std::uint64_t pixels = static_cast<std::uint64_t>(h.width) * h.height;
+  std::uint64_t planes = h.directions * pixels * sizeof(GridGraph::Weight);
+
+  // bounding the offsets by the mapping first keeps the sums from wrapping
+  if (pixels > GridGraph::NoVertex || h.fileSize > _size ||
+      h.colorsOffset > h.fileSize || h.weightsOffset > h.fileSize ||
+      h.labelsOffset > h.fileSize) {
+    return false;
+  }
+
+  return h.colorsOffset % Alignment == 0 && h.weightsOffset % Alignment == 0 &&
+         h.labelsOffset % Alignment == 0 &&
+         h.colorsOffset >= sizeof(GraphFileHeader) &&
+         h.weightsOffset >= h.colorsOffset + pixels * 3 &&
+         h.labelsOffset >= h.weightsOffset + planes &&
+         h.fileSize == h.labelsOffset + pixels * sizeof(std::uint32_t);
+}
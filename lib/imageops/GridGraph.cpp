@@ -0,0 +1,254 @@
+#include "../../include/imageops/GridGraph.h"
+
+#include <algorithm>
+
+#include "../../include/generic/BreadthFirstSearch.h"
+#include "../../include/generic/ShortestPaths.h"
+
+GridGraph::GridGraph() {}
+
+GridGraph::GridGraph(int width, int height, Neighborhood nbr)
+{
+  reset(width, height, nbr);
+}
+
+void
+GridGraph::reset(int width, int height, Neighborhood nbr)
+{
+  _width = width;
+  _height = height;
+  _nbr = nbr;
+  _directions = offsets(nbr);
+  _maxWeight = 0;
+
+  _weights.clear();
+  _weights.resize(_directions.size(), std::vector<Weight>(size(), NoEdge));
+}
+
+void
+GridGraph::widen(Neighborhood nbr)
+{
+  if (nbr == _nbr || nbr == Neighborhood::Neumann) {
+    return;
+  }
+
+  _nbr = nbr;
+  _directions = offsets(nbr);
+  _weights.resize(_directions.size(), std::vector<Weight>(size(), NoEdge));
+}
+
+void
+GridGraph::clear()
+{
+  for (auto& plane : _weights) {
+    std::fill(plane.begin(), plane.end(), NoEdge);
+  }
+
+  _maxWeight = 0;
+}
+
+int
+GridGraph::width() const
+{
+  return _width;
+}
+
+int
+GridGraph::height() const
+{
+  return _height;
+}
+
+Neighborhood
+GridGraph::neighborhood() const
+{
+  return _nbr;
+}
+
+GridGraph::Index
+GridGraph::size() const
+{
+  return static_cast<Index>(_width) * static_cast<Index>(_height);
+}
+
+int
+GridGraph::directions() const
+{
+  return _directions.size();
+}
+
+cv::Point2i
+GridGraph::direction(int dir) const
+{
+  return _directions[dir];
+}
+
+int
+GridGraph::opposite(int dir) const
+{
+  if (dir < 4) {
+    return (dir + 2) % 4;
+  }
+
+  return 4 + (dir - 2) % 4;
+}
+
+int
+GridGraph::directionTo(Index from, Index to) const
+{
+  auto delta = point(to) - point(from);
+
+  for (int dir = 0; dir < directions(); dir += 1) {
+    if (_directions[dir] == delta) {
+      return dir;
+    }
+  }
+
+  return -1;
+}
+
+GridGraph::Index
+GridGraph::index(int x, int y) const
+{
+  return static_cast<Index>(y) * _width + x;
+}
+
+GridGraph::Index
+GridGraph::index(cv::Point2i point) const
+{
+  return index(point.x, point.y);
+}
+
+cv::Point2i
+GridGraph::point(Index v) const
+{
+  return cv::Point2i(v % _width, v / _width);
+}
+
+GridGraph::Index
+GridGraph::neighbor(Index v, int dir) const
+{
+  auto p = point(v) + _directions[dir];
+
+  if (p.x < 0 || p.y < 0 || p.x >= _width || p.y >= _height) {
+    return NoVertex;
+  }
+
+  return index(p);
+}
+
+bool
+GridGraph::hasEdge(Index v, int dir) const
+{
+  return _weights[dir][v] != NoEdge && neighbor(v, dir) != NoVertex;
+}
+
+bool
+GridGraph::hasEdge(Index from, Index to) const
+{
+  auto dir = directionTo(from, to);
+
+  return dir >= 0 && hasEdge(from, dir);
+}
+
+bool
+GridGraph::hasEdges(Index v) const
+{
+  for (int dir = 0; dir < directions(); dir += 1) {
+    if (hasEdge(v, dir)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+GridGraph::Weight
+GridGraph::weight(Index v, int dir) const
+{
+  return _weights[dir][v];
+}
+
+GridGraph::Weight
+GridGraph::weight(Index from, Index to) const
+{
+  auto dir = directionTo(from, to);
+
+  if (dir < 0) {
+    return NoEdge;
+  }
+
+  return _weights[dir][from];
+}
+
+GridGraph::Weight
+GridGraph::maxWeight() const
+{
+  return _maxWeight;
+}
+
+void
+GridGraph::setWeight(Index v, int dir, Weight weight)
+{
+  if (neighbor(v, dir) == NoVertex) {
+    return;
+  }
+
+  _weights[dir][v] = weight;
+
+  if (weight != NoEdge && weight > _maxWeight) {
+    _maxWeight = weight;
+  }
+}
+
+void
+GridGraph::removeEdge(Index v, int dir)
+{
+  _weights[dir][v] = NoEdge;
+}
+
+// callers that fill weight planes directly report their largest weight here
+void
+GridGraph::raiseMaxWeight(Weight weight)
+{
+  if (weight != NoEdge && weight > _maxWeight) {
+    _maxWeight = weight;
+  }
+}
+
+std::vector<GridGraph::Weight>&
+GridGraph::weightPlane(int dir)
+{
+  return _weights[dir];
+}
+
+const std::vector<GridGraph::Weight>&
+GridGraph::weightPlane(int dir) const
+{
+  return _weights[dir];
+}
+
+// in-neighbors follow from the opposite direction planes
+bool
+GridGraph::hasReverseIndex() const
+{
+  return true;
+}
+
+std::vector<GridGraph::Index>
+GridGraph::bfs(int x, int y) const
+{
+  BreadthFirstSearch<GridGraph> search(*this);
+  search.run(index(x, y));
+
+  return search.takeOrder();
+}
+
+std::vector<int>
+GridGraph::djikstraKey(int x, int y) const
+{
+  ShortestPaths<GridGraph> paths(*this);
+  paths.run(index(x, y));
+
+  return paths.takeDistances();
+}
@@ -6,6 +6,9 @@
 #include <random>
 #include <vector>
 
+#include "../../include/generic/Heap.h"
+#include "../../include/util/Parallel.h"
+
 void
 gp::padHeight(cv::Mat& mat, int newHeight)
 {
@@ -366,6 +369,58 @@ gp::compareIntensity(cv::Vec3b l, cv::Vec3b r)
   }
 }
 
+std::vector<std::uint32_t>
+gp::brightestPixels(const cv::Mat& image, std::size_t k, int threads)
+{
+  // the intensity sits above the inverted index, so one integer compare
+  // ranks brighter pixels and then lower indices last in a min heap
+  using Brightest = Heap<std::uint64_t,
+                         std::uint32_t,
+                         std::less<std::uint64_t>,
+                         4,
+                         UnindexedPositions<std::uint32_t>>;
+
+  WorkerPool pool(threads);
+  std::vector<Brightest> kept(pool.size());
+
+  for (auto& heap : kept) {
+    heap.setCapacity(k);
+  }
+
+  pool.parallelFor(
+    image.rows,
+    [&](int worker, std::size_t begin, std::size_t end) {
+      auto& heap = kept[worker];
+
+      for (auto y = begin; y < end; y += 1) {
+        auto row = image.ptr<cv::Vec3b>(y);
+
+        for (int x = 0; x < image.cols; x += 1) {
+          std::uint32_t v = y * image.cols + x;
+          std::uint64_t intensity = row[x][0] + row[x][1] + row[x][2];
+
+          heap.insert((intensity << 32) | (UINT32_MAX - v), v);
+        }
+      }
+    },
+    16);
+
+  for (std::size_t worker = 1; worker < kept.size(); worker += 1) {
+    kept[0].meld(kept[worker]);
+  }
+
+  // the weakest of the kept pixels comes out first
+  auto top = kept[0].extractTopK(k);
+  std::vector<std::uint32_t> pixels;
+  pixels.reserve(top.size());
+
+  for (auto it = top.rbegin(); it != top.rend(); ++it) {
+    pixels.push_back(it->second);
+  }
+
+  return pixels;
+}
+
 void
 gp::swapPixels(cv::Mat& image, cv::Point l, cv::Point r)
 {
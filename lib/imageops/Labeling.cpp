@@ -0,0 +1,219 @@
+#include "../../include/imageops/Labeling.h"
+
+#include <algorithm>
+
+#include "../../include/generic/ConcurrentUnionFind.h"
+#include "../../include/util/Parallel.h"
+
+namespace {
+// Labels a width x height lattice in three parallel passes over row bands:
+// unions inside each band, unions across band borders, then a relabel of
+// the leaders to consecutive ids in raster order. isForeground(v) selects
+// the vertices to label and linked(v, dir) tells whether v joins its
+// neighbor in direction dir.
+template<class Foreground, class Linked>
+std::size_t
+labelBands(int width,
+           int height,
+           const std::vector<cv::Point2i>& directions,
+           Foreground isForeground,
+           Linked linked,
+           std::vector<std::uint32_t>& labels,
+           int threads)
+{
+  using Index = std::uint32_t;
+
+  WorkerPool pool(threads);
+  ConcurrentUnionFind<Index> sets(static_cast<std::size_t>(width) * height);
+
+  int bands = std::min(height, pool.size() * 4);
+  labels.assign(sets.size(), gp::NoLabel);
+
+  if (bands == 0) {
+    return 0;
+  }
+
+  auto bandRows = [&](std::size_t band) {
+    return std::make_pair(static_cast<int>(band * height / bands),
+                          static_cast<int>((band + 1) * height / bands));
+  };
+
+  // unions rows of the band [bandBegin, bandEnd) with their neighbors either
+  // inside the band or, when crossing, outside it
+  int dirs = directions.size();
+
+  auto unionRows = [&](int rowBegin,
+                       int rowEnd,
+                       int bandBegin,
+                       int bandEnd,
+                       bool crossing) {
+    for (int y = rowBegin; y < rowEnd; y += 1) {
+      for (int x = 0; x < width; x += 1) {
+        Index v = static_cast<Index>(y) * width + x;
+
+        if (!isForeground(v)) {
+          continue;
+        }
+
+        for (int dir = 0; dir < dirs; dir += 1) {
+          int nx = x + directions[dir].x;
+          int ny = y + directions[dir].y;
+
+          if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+            continue;
+          }
+
+          bool inBand = ny >= bandBegin && ny < bandEnd;
+          if (inBand != crossing && linked(v, dir)) {
+            sets.unionVertices(v, static_cast<Index>(ny) * width + nx);
+          }
+        }
+      }
+    }
+  };
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto rows = bandRows(band);
+        unionRows(rows.first, rows.second, rows.first, rows.second, false);
+      }
+    },
+    1);
+
+  // only the first and last row of a band have neighbors outside it
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto rows = bandRows(band);
+        unionRows(rows.first, rows.first + 1, rows.first, rows.second, true);
+
+        if (rows.second - 1 > rows.first) {
+          unionRows(
+            rows.second - 1, rows.second, rows.first, rows.second, true);
+        }
+      }
+    },
+    1);
+
+  // leaders are the smallest index of their component, so numbering them
+  // band by band gives ids in raster order of first appearance
+  std::vector<std::size_t> roots(bands + 1, 0);
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto rows = bandRows(band);
+        Index first = static_cast<Index>(rows.first) * width;
+        Index last = static_cast<Index>(rows.second) * width;
+
+        for (Index v = first; v < last; v += 1) {
+          if (isForeground(v) && sets.find(v) == v) {
+            labels[v] = roots[band + 1];
+            roots[band + 1] += 1;
+          }
+        }
+      }
+    },
+    1);
+
+  for (int band = 0; band < bands; band += 1) {
+    roots[band + 1] += roots[band];
+  }
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto rows = bandRows(band);
+        Index first = static_cast<Index>(rows.first) * width;
+        Index last = static_cast<Index>(rows.second) * width;
+
+        for (Index v = first; v < last; v += 1) {
+          if (labels[v] != gp::NoLabel) {
+            labels[v] += roots[band];
+          }
+        }
+      }
+    },
+    1);
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto rows = bandRows(band);
+        Index first = static_cast<Index>(rows.first) * width;
+        Index last = static_cast<Index>(rows.second) * width;
+
+        for (Index v = first; v < last; v += 1) {
+          auto leader = sets.find(v);
+
+          if (isForeground(v) && leader != v) {
+            labels[v] = labels[leader];
+          }
+        }
+      }
+    },
+    1);
+
+  return roots[bands];
+}
+} // namespace
+
+std::size_t
+gp::labelComponents(const cv::Mat& mask,
+                    Neighborhood nbr,
+                    std::vector<std::uint32_t>& labels,
+                    int threads)
+{
+  int width = mask.size().width;
+  auto directions = offsets(nbr);
+
+  auto isForeground = [&](std::uint32_t v) {
+    return mask.ptr<unsigned char>(v / width)[v % width] != 0;
+  };
+
+  auto linked = [&](std::uint32_t v, int dir) {
+    int x = v % width + directions[dir].x;
+    int y = v / width + directions[dir].y;
+
+    return mask.ptr<unsigned char>(y)[x] != 0;
+  };
+
+  return labelBands(width,
+                    mask.size().height,
+                    directions,
+                    isForeground,
+                    linked,
+                    labels,
+                    threads);
+}
+
+std::size_t
+gp::labelComponents(const GridGraph& graph,
+                    std::vector<std::uint32_t>& labels,
+                    int threads)
+{
+  std::vector<cv::Point2i> directions;
+  for (int dir = 0; dir < graph.directions(); dir += 1) {
+    directions.push_back(graph.direction(dir));
+  }
+
+  auto isForeground = [](std::uint32_t) { return true; };
+
+  auto linked = [&](std::uint32_t v, int dir) {
+    return graph.weight(v, dir) != GridGraph::NoEdge;
+  };
+
+  return labelBands(graph.width(),
+                    graph.height(),
+                    directions,
+                    isForeground,
+                    linked,
+                    labels,
+                    threads);
+}
@@ -0,0 +1,121 @@
+#include "../../include/imageops/Paint.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "../../include/util/Parallel.h"
+
+float
+gp::ringShader(int distance, int maxDistance, float intensity)
+{
+  double ratio = maxDistance > 0 ? (double)distance / maxDistance : 0.0;
+  double modulation =
+    std::sin(M_PI * 2 * ratio + ratio * std::cos(M_PI * 2 * ratio)) + 1;
+
+  return 1.f + modulation / (intensity + 1.f);
+}
+
+gp::ShadeTable::ShadeTable(const Shader& shader,
+                           int maxDistance,
+                           int intensityLevels,
+                           int distanceBuckets)
+  : _maxDistance(std::max(maxDistance, 0))
+  , _levels(std::max(intensityLevels, 1))
+  , _buckets(std::min(_maxDistance, std::max(distanceBuckets, 1) - 1) + 1)
+  , _gains(static_cast<std::size_t>(_buckets) * _levels)
+{
+  for (int b = 0; b < _buckets; b += 1) {
+    // each bucket is shaded at the shortest distance it holds
+    int distance =
+      _buckets > 1
+        ? static_cast<int>(static_cast<std::size_t>(b) * _maxDistance /
+                           (_buckets - 1))
+        : 0;
+
+    for (int level = 0; level < _levels; level += 1) {
+      float intensity = (level + 0.5f) / _levels;
+      float gain = shader(distance, _maxDistance, intensity);
+
+      _gains[static_cast<std::size_t>(b) * _levels + level] =
+        cv::saturate_cast<std::uint16_t>(std::max(gain, 0.f) * 256.f);
+    }
+  }
+}
+
+int
+gp::ShadeTable::maxDistance() const
+{
+  return _maxDistance;
+}
+
+cv::Vec3b
+gp::ShadeTable::shade(cv::Vec3b color, int distance) const
+{
+  int level = (color[0] + color[1] + color[2]) * _levels / 766;
+  unsigned int gain = _gains[bucket(distance) * _levels + level];
+
+  return cv::Vec3b(std::min((color[0] * gain + 128) >> 8, 255u),
+                   std::min((color[1] * gain + 128) >> 8, 255u),
+                   std::min((color[2] * gain + 128) >> 8, 255u));
+}
+
+std::size_t
+gp::ShadeTable::bucket(int distance) const
+{
+  if (_buckets == 1 || distance <= 0) {
+    return 0;
+  }
+
+  auto clamped = static_cast<std::size_t>(std::min(distance, _maxDistance));
+
+  return clamped * (_buckets - 1) / _maxDistance;
+}
+
+void
+gp::paintLabels(const cv::Mat& colors,
+                const std::vector<int>& distances,
+                const std::vector<std::uint32_t>& labels,
+                const ShadeTable& table,
+                cv::Mat& canvas,
+                int threads)
+{
+  int width = colors.size().width;
+  int height = colors.size().height;
+
+  if (canvas.size().width != width || canvas.size().height != height) {
+    cv::resize(canvas, canvas, cv::Size(width, height), cv::INTER_LINEAR);
+  }
+
+  WorkerPool pool(threads);
+
+  // every pixel is written from its own row, so row bands need no locking
+  pool.parallelFor(
+    height,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto y = begin; y < end; y += 1) {
+        auto row = canvas.ptr<cv::Vec3b>(y);
+        std::size_t rowStart = y * width;
+
+        for (int x = 0; x < width; x += 1) {
+          auto v = rowStart + x;
+
+          if (distances[v] == INT_MAX) {
+            continue;
+          }
+
+          auto leader = labels[v];
+          auto distance = distances[leader];
+
+          if (distance == INT_MAX) {
+            distance = table.maxDistance();
+          }
+
+          row[x] = table.shade(
+            colors.at<cv::Vec3b>(leader / width, leader % width), distance);
+        }
+      }
+    },
+    16);
+}
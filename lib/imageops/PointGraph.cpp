@@ -1,329 +1,414 @@
 #include "../../include/imageops/PointGraph.h"
 
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <cmath>
+#include <functional>
 #include <iostream>
-#include <opencv2/imgproc.hpp>
-#include <queue>
 #include <random>
 
-#include "../../include/generic/Heap.h"
+#include "../../include/generic/BreadthFirstSearch.h"
+#include "../../include/generic/DeltaStepping.h"
+#include "../../include/generic/ParallelBreadthFirstSearch.h"
+#include "../../include/generic/ShortestPaths.h"
+#include "../../include/imageops/GraphFile.h"
 #include "../../include/imageops/ImageOps.h"
+#include "../../include/imageops/Paint.h"
+#include "../../include/imageops/Segmentation.h"
+#include "../../include/util/Parallel.h"
 
 PointGraph::PointGraph() {}
 
 void
-PointGraph::paintImage(cv::Mat& canvas)
+PointGraph::paintImage(cv::Mat& canvas, const gp::Shader& shader)
 {
-  if (_pointGraph.getAdjacencyLists().size() == 0) {
+  if (_grid.size() == 0) {
     return;
   }
 
   std::random_device rd;
   std::mt19937 gen(rd());
 
-  std::queue<Vertex> toSearch;
-  std::map<Vertex, bool> visited;
-
-  auto it = _pointGraph.getAdjacencyLists().begin();
-  std::advance(it, gen() % _pointGraph.getAdjacencyLists().size());
-  auto srcVertex = it->first;
-  auto key = djikstraKey(srcVertex->x(), srcVertex->y());
+  auto srcVertex = _grid.point(gen() % _grid.size());
+  auto key = djikstraKey(srcVertex.x, srcVertex.y);
   int maxDistance = 0;
 
-  for (auto& vertex : _pointGraph.getAdjacencyLists()) {
-    visited.insert({ vertex.first, false });
-
-    if (key[vertex.first] > maxDistance) {
-      maxDistance = key[vertex.first];
+  for (auto distance : key) {
+    if (distance != INT_MAX && distance > maxDistance) {
+      maxDistance = distance;
     }
   }
 
-  visited[srcVertex] = true;
-  toSearch.push(srcVertex);
-
-  cv::resize(
-    canvas, canvas, cv::Size(_bottomRight.x, _bottomRight.y), cv::INTER_LINEAR);
-
-  while (!toSearch.empty()) {
-    auto searchVertex = toSearch.front();
-    auto colorVertex = _unionFind.find(searchVertex);
-    auto distance = key[colorVertex];
-    auto color = colorVertex->color() +
-                 (colorVertex->color() *
-                  (std::sin((M_PI * 2 * distance) / maxDistance +
-                            ((float)distance / maxDistance) *
-                              std::cos((M_PI * 2 * distance) / maxDistance)) +
-                   1)) /
-                   (((float)(colorVertex->color()[0] + colorVertex->color()[1] +
-                             colorVertex->color()[2]) /
-                     255.f / 3.f) +
-                    1.f);
-
-    toSearch.pop();
-
-    cv::circle(canvas, searchVertex->point(), 0, color);
-
-    for (auto& destVertex : _pointGraph.connectedTo(searchVertex)) {
-      if (!visited[destVertex.first]) {
-        visited[destVertex.first] = true;
-        toSearch.push(destVertex.first);
-      }
-    }
-  }
+  auto labels = _unionFind.flatten();
+
+  gp::paintLabels(
+    _colors, key, labels, gp::ShadeTable(shader, maxDistance), canvas);
 }
 
 void
 PointGraph::addVerticesFromImage(cv::Mat& fromImage)
 {
-  _pointGraph.clear();
-  _pointMap.clear();
-  _unionFind.clear();
-
   _bottomRight = cv::Point2i(fromImage.size().width, fromImage.size().height);
 
-  for (int x = 0; x < fromImage.size().width; x += 1) {
-    _pointMap.insert({ x, std::map<int, Vertex>() });
-    for (int y = 0; y < fromImage.size().height; y += 1) {
-      auto pV = std::make_shared<PointVertex>(cv::Point2i(x, y),
-                                              fromImage.at<cv::Vec3b>(y, x));
-
-      _pointGraph.addVertex(pV);
-
-      _pointMap[x].insert({ y, pV });
-
-      _unionFind.insert(pV);
-    }
-  }
+  _colors = fromImage.clone();
+  _grid.reset(_bottomRight.x, _bottomRight.y, Neighborhood::Neumann);
+  _unionFind.reset(_grid.size());
 }
 
 void
-PointGraph::connectAllNeighbors(int width, int height, Neighborhood nbr)
+PointGraph::connectAllNeighbors(int width,
+                                int height,
+                                Neighborhood nbr,
+                                gp::WeightMetric metric,
+                                int threads)
 {
   std::random_device rd;
-  std::mt19937 gen(rd());
-  int weight = 0;
-  for (int x = 0; x < width; x += 1) {
-    for (int y = 0; y < height; y += 1) {
-      auto nbrs = neighbors(nbr, cv::Point(x, y), 0, 0, width - 1, height - 1);
 
-      for (auto& n : nbrs) {
-        weight = gen() % 10;
+  _grid.widen(nbr);
 
-        _pointGraph.addNewEdge(_pointMap[x][y], _pointMap[n.x][n.y], weight);
-      }
-    }
-  }
+  gp::weighEdges(_colors,
+                 nbr,
+                 metric,
+                 (static_cast<std::uint64_t>(rd()) << 32) | rd(),
+                 cv::Rect(0, 0, width, height),
+                 _grid,
+                 threads);
 }
 
 void
 PointGraph::connectRandom(int maxEdges)
 {
   std::random_device rd;
-  std::mt19937 gen(rd());
 
-  int edges = 0;
-  int weight = 0;
-
-  for (auto& startVertex : _pointGraph.getAdjacencyLists()) {
-    edges = (gen() % maxEdges) + 1;
-
-    auto nbrs = neighbors(Neighborhood::Moore,
-                          startVertex.first->point(),
-                          0,
-                          0,
-                          _bottomRight.x - 1,
-                          _bottomRight.y - 1);
-
-    int nIndex = 0;
-    while (edges > 0) {
-      if (gen() % 1000 < 100) {
-        _pointGraph.addNewEdge(
-          startVertex.first, _pointMap[nbrs[nIndex].x][nbrs[nIndex].y], weight);
-        edges -= 1;
-      }
-      nIndex = (static_cast<unsigned long>(nIndex) == nbrs.size() - 1)
-                 ? 0
-                 : nIndex + 1;
-    }
+  connectRandom(maxEdges, (static_cast<std::uint64_t>(rd()) << 32) | rd());
+}
+
+void
+PointGraph::connectRandom(int maxEdges, std::uint64_t seed, int threads)
+{
+  if (maxEdges <= 0) {
+    return;
   }
 
-  for (auto& startVertex : _pointGraph.getAdjacencyLists()) {
-    for (auto& endVertex : _pointGraph.connectedTo(startVertex.first)) {
-      if (gp::compareIntensity(startVertex.first->color(),
-                               endVertex.first->color()) < 0) {
-        _unionFind.unionVertices(startVertex.first, endVertex.first);
+  Philox rng(seed);
+  WorkerPool pool(threads);
+
+  _grid.widen(Neighborhood::Moore);
+
+  // every vertex draws how many edges it wants, then that many distinct
+  // in-bounds directions by a partial Fisher-Yates shuffle; each draw is
+  // keyed by the vertex, and a vertex only writes its own plane entries
+  pool.parallelFor(
+    _bottomRight.y,
+    [&](int, std::size_t begin, std::size_t end) {
+      std::array<int, 8> nbrs;
+
+      for (auto y = begin; y < end; y += 1) {
+        for (int x = 0; x < _bottomRight.x; x += 1) {
+          auto v = _grid.index(x, y);
+          int count = 0;
+
+          for (int dir = 0; dir < _grid.directions(); dir += 1) {
+            if (_grid.neighbor(v, dir) != GridGraph::NoVertex) {
+              nbrs[count] = dir;
+              count += 1;
+            }
+          }
+
+          int edges = std::min<int>(rng.draw(v) % maxEdges + 1, count);
+
+          for (int i = 0; i < edges; i += 1) {
+            std::swap(nbrs[i], nbrs[i + rng.draw(v, i + 1) % (count - i)]);
+
+            auto& weight = _grid.weightPlane(nbrs[i])[v];
+            if (weight == GridGraph::NoEdge) {
+              weight = 0;
+            }
+          }
+        }
       }
-    }
-  }
+    },
+    16);
+
+  _grid.raiseMaxWeight(0);
+
+  pool.parallelFor(
+    _grid.size(),
+    [&](int, std::size_t begin, std::size_t end) {
+      for (Vertex v = begin; v < end; v += 1) {
+        _grid.forEachNeighbor(v, [&](Vertex to, GridGraph::Weight) {
+          if (gp::compareIntensity(color(v), color(to)) < 0) {
+            _unionFind.unionVertices(v, to);
+          }
+        });
+      }
+    },
+    4096);
 }
 
 void
-PointGraph::unionChunk(int x, int y, int depth, Neighborhood n)
+PointGraph::unionChunk(int x,
+                       int y,
+                       int depth,
+                       Neighborhood n,
+                       std::uint64_t seed)
+{
+  unionWalk(_grid.index(x, y), depth, offsets(n), Philox(seed));
+}
+
+void
+PointGraph::unionChunks(Neighborhood nbr, float vP)
 {
   std::random_device rd;
-  std::mt19937 gen(rd());
 
-  auto center = cv::Point(x, y);
+  unionChunks(nbr, vP, (static_cast<std::uint64_t>(rd()) << 32) | rd());
+}
+
+void
+PointGraph::unionChunks(Neighborhood nbr,
+                        float vP,
+                        std::uint64_t seed,
+                        int threads)
+{
+  Philox rng(seed);
+  auto directions = offsets(nbr);
+  auto threshold = 1000.f * vP;
+
+  // each pixel's coin flip and walk are keyed by its index, and the
+  // concurrent union-find ends with the same sets whatever the interleaving
+  WorkerPool pool(threads);
+  pool.parallelFor(
+    _bottomRight.y,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto y = begin; y < end; y += 1) {
+        for (int x = 0; x < _bottomRight.x; x += 1) {
+          auto v = _grid.index(x, y);
+
+          if (rng.draw(v) % 1000 < threshold) {
+            unionWalk(v, 1, directions, rng);
+          }
+        }
+      }
+    },
+    16);
+}
+
+void
+PointGraph::unionWalk(Vertex start,
+                      int depth,
+                      const std::vector<cv::Point2i>& directions,
+                      const Philox& rng)
+{
+  auto center = _grid.point(start);
+  std::array<cv::Point2i, 8> nbrs;
 
   for (auto i = 0; i < depth; i += 1) {
-    auto nbrs =
-      neighbors(n, center, 0, 0, _bottomRight.x - 1, _bottomRight.y - 1);
+    std::size_t count = 0;
+
+    for (auto& direction : directions) {
+      auto nbr = center + direction;
 
-    for (auto& nbr : nbrs) {
-      _unionFind.unionVertices(_pointMap[center.x][center.y],
-                               _pointMap[nbr.x][nbr.y]);
+      if (nbr.x >= 0 && nbr.y >= 0 && nbr.x < _bottomRight.x &&
+          nbr.y < _bottomRight.y) {
+        _unionFind.unionVertices(_grid.index(center), _grid.index(nbr));
+        nbrs[count] = nbr;
+        count += 1;
+      }
     }
 
-    center = nbrs[gen() % nbrs.size()];
+    if (count == 0) {
+      return;
+    }
+
+    center = nbrs[rng.draw(start, i + 1) % count];
   }
 }
 
-void
-PointGraph::unionChunks(Neighborhood nbr, float vP)
+std::size_t
+PointGraph::segment(Neighborhood nbr, float k, int minSize, int threads)
 {
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  std::vector<std::uint32_t> labels;
+  auto regions = gp::segmentImage(_colors, nbr, k, minSize, labels, threads);
 
-  int x = 0;
-  int y = 0;
+  _unionFind.reset(_grid.size());
+  for (Vertex v = 0; v < labels.size(); v += 1) {
+    _unionFind.unionVertices(v, labels[v]);
+  }
 
-  while (x < _bottomRight.x) {
-    while (y < _bottomRight.y) {
-      if (gen() % 1000 < (1000.f * vP)) {
-        unionChunk(x, y, 1, nbr);
-      }
+  return regions;
+}
 
-      y += 1;
-    }
+std::vector<Vertex>
+PointGraph::djikstraPaths(int x, int y)
+{
+  ShortestPaths<GridGraph> paths(_grid);
+  paths.run(_grid.index(x, y), true);
 
-    x += 1;
-    y = 0;
+  return paths.takePredecessors();
+}
+
+std::vector<int>
+PointGraph::djikstraKey(int x, int y, int threads)
+{
+  if (threads != 1) {
+    WorkerPool pool(threads);
+    DeltaStepping<GridGraph> paths(_grid, pool);
+    paths.run(_grid.index(x, y));
+
+    return paths.takeDistances();
   }
+
+  ShortestPaths<GridGraph> paths(_grid);
+  paths.run(_grid.index(x, y));
+
+  return paths.takeDistances();
 }
 
-std::map<Vertex, Vertex>
-PointGraph::djikstraPaths(int x, int y)
+void
+PointGraph::nearestSeeds(const std::vector<Seed>& seeds,
+                         std::vector<int>& distances,
+                         std::vector<Vertex>& labels,
+                         int maxDistance,
+                         std::size_t maxVertices)
 {
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  ShortestPaths<GridGraph> paths(_grid);
+  paths.run(seeds, { maxDistance, maxVertices });
 
-  std::map<Vertex, Vertex> paths;
+  distances = paths.takeDistances();
+  labels = paths.takeLabels();
+}
 
-  std::map<Vertex, bool> processed;
-  std::map<Vertex, int> key;
-  std::map<Vertex, int> distances;
+void
+PointGraph::bfs(int x,
+                int y,
+                std::vector<Vertex>& order,
+                std::vector<int>& levels,
+                std::vector<Vertex>& parents) const
+{
+  BreadthFirstSearch<GridGraph> search(_grid);
+  search.run(_grid.index(x, y), true);
 
-  Heap<int, std::pair<Vertex, Vertex>> unprocessed;
+  order = search.takeOrder();
+  levels = search.takeLevels();
+  parents = search.takeParents();
+}
 
-  for (auto& vertex : _pointGraph.getAdjacencyLists()) {
-    processed.insert({ vertex.first, false });
-    key.insert({ vertex.first, INT_MAX });
-    distances.insert({ vertex.first, INT_MAX });
-    paths.insert({ vertex.first, nullptr });
-  }
+std::vector<int>
+PointGraph::bfsLevels(int x, int y, int threads) const
+{
+  if (threads == 1) {
+    BreadthFirstSearch<GridGraph> search(_grid);
+    search.run(_grid.index(x, y), true);
 
-  auto sourceVertex = _pointMap[x][y];
-
-  processed[sourceVertex] = true;
-  key[sourceVertex] = 0;
-  distances[sourceVertex] = 0;
-
-  for (auto& aroundSource : _pointGraph.connectedTo(sourceVertex)) {
-    unprocessed.insert(_pointGraph.weight(sourceVertex, aroundSource.first),
-                       std::make_pair(sourceVertex, aroundSource.first));
-    processed[aroundSource.first] = true;
-    distances[aroundSource.first] =
-      _pointGraph.weight(sourceVertex, aroundSource.first);
-    key[aroundSource.first] =
-      _pointGraph.weight(sourceVertex, aroundSource.first);
-    paths[aroundSource.first] = sourceVertex;
+    return search.takeLevels();
   }
 
-  while (!unprocessed.empty()) {
-    auto toProcess = unprocessed.extractMin();
+  WorkerPool pool(threads);
+  ParallelBreadthFirstSearch<GridGraph> search(_grid, pool);
+  search.run(_grid.index(x, y));
 
-    for (auto& destVertex : _pointGraph.connectedTo(toProcess.second)) {
-      if (!processed[destVertex.first]) {
-        processed[destVertex.first] = true;
+  return search.takeLevels();
+}
 
-        distances[destVertex.first] =
-          _pointGraph.weight(toProcess.second, destVertex.first) +
-          key[toProcess.second];
+std::vector<WeightedEdge>
+PointGraph::spanningForest(int threads) const
+{
+  WorkerPool pool(threads);
+  SpanningForest<GridGraph> forest(_grid, pool);
+  forest.run();
 
-        if (distances[destVertex.first] < key[destVertex.first]) {
-          key[destVertex.first] = distances[destVertex.first];
-          paths[destVertex.first] = toProcess.second;
-        }
+  return forest.takeEdges();
+}
 
-        unprocessed.insert(distances[destVertex.first],
-                           std::make_pair(toProcess.second, destVertex.first));
-      }
-    }
+Graph<Vertex>
+PointGraph::subgraph(const std::vector<Vertex>& vertices) const
+{
+  Graph<Vertex> connected;
+
+  for (auto vertex : vertices) {
+    connected.addVertex(vertex);
+
+    _grid.forEachNeighbor(vertex, [&](Vertex destVertex, GridGraph::Weight w) {
+      connected.addNewEdge(vertex, destVertex, w);
+    });
   }
 
-  return paths;
+  return connected;
 }
 
-std::map<Vertex, int>
-PointGraph::djikstraKey(int x, int y)
+Vertex
+PointGraph::index(int x, int y) const
 {
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  return _grid.index(x, y);
+}
 
-  std::map<Vertex, bool> processed;
-  std::map<Vertex, int> key;
-  std::map<Vertex, int> distances;
+PointVertex
+PointGraph::vertex(Vertex v) const
+{
+  return PointVertex(_grid.point(v), color(v));
+}
 
-  Heap<int, std::pair<Vertex, Vertex>> unprocessed;
+cv::Vec3b
+PointGraph::color(Vertex v) const
+{
+  return _colors.at<cv::Vec3b>(v / _bottomRight.x, v % _bottomRight.x);
+}
 
-  for (auto& vertex : _pointGraph.getAdjacencyLists()) {
-    processed.insert({ vertex.first, false });
-    key.insert({ vertex.first, INT_MAX });
-    distances.insert({ vertex.first, INT_MAX });
-  }
+GridGraph&
+PointGraph::grid()
+{
+  return _grid;
+}
 
-  auto sourceVertex = _pointMap[x][y];
+bool
+PointGraph::save(const std::string& path)
+{
+  return gp::writeGraphFile(path, _colors, _grid, _unionFind.flatten());
+}
 
-  processed[sourceVertex] = true;
-  key[sourceVertex] = 0;
-  distances[sourceVertex] = 0;
+// The sections are copied out of the mapping whole; only the leaders are
+// checked, as the union-find relies on every set being led by its smallest
+// member
+bool
+PointGraph::load(const std::string& path)
+{
+  gp::GraphFile file;
 
-  for (auto& aroundSource : _pointGraph.connectedTo(sourceVertex)) {
-    unprocessed.insert(_pointGraph.weight(sourceVertex, aroundSource.first),
-                       std::make_pair(sourceVertex, aroundSource.first));
-    processed[aroundSource.first] = true;
-    distances[aroundSource.first] =
-      _pointGraph.weight(sourceVertex, aroundSource.first);
-    key[aroundSource.first] =
-      _pointGraph.weight(sourceVertex, aroundSource.first);
+  if (!file.open(path)) {
+    return false;
   }
 
-  while (!unprocessed.empty()) {
-    auto toProcess = unprocessed.extractMin();
+  auto size = file.size();
+  auto labels = file.labels();
 
-    for (auto& destVertex : _pointGraph.connectedTo(toProcess.second)) {
-      if (!processed[destVertex.first]) {
-        processed[destVertex.first] = true;
+  for (Vertex v = 0; v < size; v += 1) {
+    if (labels[v] > v || labels[labels[v]] != labels[v]) {
+      return false;
+    }
+  }
 
-        distances[destVertex.first] =
-          _pointGraph.weight(toProcess.second, destVertex.first) +
-          key[toProcess.second];
+  _bottomRight = cv::Point2i(file.width(), file.height());
+  _colors = file.colors().clone();
+  _grid.reset(file.width(), file.height(), file.neighborhood());
 
-        if (distances[destVertex.first] < key[destVertex.first]) {
-          key[destVertex.first] = distances[destVertex.first];
-        }
+  // the largest weight is taken from the planes rather than the header, as
+  // one that is too small would make the shortest path buckets wrap
+  GridGraph::Weight maxWeight = 0;
+
+  for (int dir = 0; dir < file.directions(); dir += 1) {
+    auto plane = file.weightPlane(dir);
+    std::copy(plane, plane + size, _grid.weightPlane(dir).begin());
 
-        unprocessed.insert(distances[destVertex.first],
-                           std::make_pair(toProcess.second, destVertex.first));
+    for (Vertex v = 0; v < size; v += 1) {
+      if (plane[v] != GridGraph::NoEdge) {
+        maxWeight = std::max(maxWeight, plane[v]);
       }
     }
   }
 
-  return key;
-}
+  _grid.raiseMaxWeight(maxWeight);
+  _unionFind.reset(size, labels);
 
-Graph<Vertex>
-PointGraph::bfs(int x, int y)
-{
-  return _pointGraph.bfs(_pointMap[x][y]);
+  return true;
 }
@@ -0,0 +1,170 @@
+#include "../../include/imageops/Segmentation.h"
+
+#include <algorithm>
+
+#include "../../include/generic/UnionFind.h"
+#include "../../include/imageops/EdgeWeights.h"
+#include "../../include/util/Parallel.h"
+
+namespace {
+// rounded Euclidean distances between 8-bit colors lie in [0, 442]
+constexpr int WeightLevels = 443;
+} // namespace
+
+std::size_t
+gp::segmentImage(const cv::Mat& image,
+                 Neighborhood nbr,
+                 float k,
+                 int minSize,
+                 std::vector<std::uint32_t>& labels,
+                 int threads)
+{
+  using Index = std::uint32_t;
+
+  // 64 bits, as v * forward + direction outgrows 32 for large images
+  using EdgeId = std::uint64_t;
+
+  int width = image.size().width;
+  int height = image.size().height;
+  std::size_t size = static_cast<std::size_t>(width) * height;
+
+  // every edge is kept once, from the vertex whose neighbor follows it in
+  // raster order; edge ids are v * forward + direction
+  std::vector<cv::Point2i> directions;
+  for (auto& offset : offsets(nbr)) {
+    if (offset.y > 0 || (offset.y == 0 && offset.x > 0)) {
+      directions.push_back(offset);
+    }
+  }
+  int forward = directions.size();
+
+  WorkerPool pool(threads);
+  int bands = std::min(height, pool.size() * 4);
+
+  if (bands == 0) {
+    labels.clear();
+    return 0;
+  }
+
+  auto bandRows = [&](std::size_t band) {
+    return std::make_pair(static_cast<int>(band * height / bands),
+                          static_cast<int>((band + 1) * height / bands));
+  };
+
+  // calls fn(edge, weight) for each edge leaving the rows of a band
+  auto forEachEdge = [&](std::size_t band, auto fn) {
+    auto rows = bandRows(band);
+
+    for (int y = rows.first; y < rows.second; y += 1) {
+      auto row = image.ptr<unsigned char>(y);
+
+      for (int dir = 0; dir < forward; dir += 1) {
+        int ny = y + directions[dir].y;
+
+        if (ny >= height) {
+          continue;
+        }
+
+        auto nrow = image.ptr<unsigned char>(ny);
+        int dx = directions[dir].x;
+        int xBegin = std::max(0, -dx);
+        int xEnd = std::min(width, width - dx);
+
+        for (int x = xBegin; x < xEnd; x += 1) {
+          EdgeId v = static_cast<EdgeId>(y) * width + x;
+          auto c1 = row + 3 * x;
+          auto c2 = nrow + 3 * (x + dx);
+
+          fn(v * forward + dir,
+             colorDistanceL2(c1[0] - c2[0], c1[1] - c2[1], c1[2] - c2[2]));
+        }
+      }
+    }
+  };
+
+  // counting sort by weight: per band histograms, then each band scatters
+  // into its own slice of every weight bucket, so the order is stable
+  std::vector<std::size_t> counts(bands * WeightLevels, 0);
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto histogram = &counts[band * WeightLevels];
+        forEachEdge(band, [&](EdgeId, int w) { histogram[w] += 1; });
+      }
+    },
+    1);
+
+  std::vector<std::size_t> levelBegin(WeightLevels + 1, 0);
+  std::size_t edgeCount = 0;
+
+  for (int w = 0; w < WeightLevels; w += 1) {
+    levelBegin[w] = edgeCount;
+
+    for (int band = 0; band < bands; band += 1) {
+      auto count = counts[band * WeightLevels + w];
+      counts[band * WeightLevels + w] = edgeCount;
+      edgeCount += count;
+    }
+  }
+  levelBegin[WeightLevels] = edgeCount;
+
+  std::vector<EdgeId> edges(edgeCount);
+
+  pool.parallelFor(
+    bands,
+    [&](int, std::size_t begin, std::size_t end) {
+      for (auto band = begin; band < end; band += 1) {
+        auto next = &counts[band * WeightLevels];
+        forEachEdge(band, [&](EdgeId e, int w) {
+          edges[next[w]] = e;
+          next[w] += 1;
+        });
+      }
+    },
+    1);
+
+  auto target = [&](EdgeId e) {
+    auto v = static_cast<Index>(e / forward);
+    auto& offset = directions[e % forward];
+
+    return static_cast<Index>(v + offset.y * width + offset.x);
+  };
+
+  // edges arrive in increasing weight, so the edge that merges two regions
+  // is the largest internal difference of the union
+  DenseUnionFind<Index> sets(size);
+  std::vector<std::uint16_t> internal(size, 0);
+
+  for (int w = 0; w < WeightLevels; w += 1) {
+    for (auto i = levelBegin[w]; i < levelBegin[w + 1]; i += 1) {
+      auto a = sets.find(static_cast<Index>(edges[i] / forward));
+      auto b = sets.find(target(edges[i]));
+
+      if (a == b || w > internal[a] + k / sets.componentSize(a) ||
+          w > internal[b] + k / sets.componentSize(b)) {
+        continue;
+      }
+
+      sets.unionVertices(a, b);
+      internal[sets.find(a)] = w;
+    }
+  }
+
+  if (minSize > 1) {
+    for (auto e : edges) {
+      auto a = sets.find(static_cast<Index>(e / forward));
+      auto b = sets.find(target(e));
+
+      if (a != b && (sets.componentSize(a) < static_cast<Index>(minSize) ||
+                     sets.componentSize(b) < static_cast<Index>(minSize))) {
+        sets.unionVertices(a, b);
+      }
+    }
+  }
+
+  labels = sets.flatten();
+
+  return sets.components();
+}
@@ -48,3 +48,20 @@ neighbors(Neighborhood n,
 
   return points;
 }
+
+std::vector<cv::Point>
+offsets(Neighborhood n)
+{
+  std::vector<cv::Point> points{
+    cv::Point(1, 0), cv::Point(0, 1), cv::Point(-1, 0), cv::Point(0, -1)
+  };
+
+  if (n == Neighborhood::Moore) {
+    points.push_back(cv::Point(1, 1));
+    points.push_back(cv::Point(-1, 1));
+    points.push_back(cv::Point(-1, -1));
+    points.push_back(cv::Point(1, -1));
+  }
+
+  return points;
+}
@@ -0,0 +1,90 @@
+#include "../../include/util/Parallel.h"
+
+int
+defaultThreads()
+{
+  int threads = std::thread::hardware_concurrency();
+
+  return threads > 0 ? threads : 1;
+}
+
+WorkerPool::WorkerPool(int threads)
+{
+  if (threads <= 0) {
+    threads = defaultThreads();
+  }
+
+  for (int worker = 1; worker < threads; worker += 1) {
+    _threads.emplace_back(&WorkerPool::work, this, worker);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+
+  _start.notify_all();
+
+  for (auto& thread : _threads) {
+    thread.join();
+  }
+}
+
+int
+WorkerPool::size() const
+{
+  return _threads.size() + 1;
+}
+
+void
+WorkerPool::run(const std::function<void(int)>& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _remaining = _threads.size();
+    _generation += 1;
+  }
+
+  _start.notify_all();
+
+  task(0);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done.wait(lock, [this] { return _remaining == 0; });
+  _task = nullptr;
+}
+
+void
+WorkerPool::work(int worker)
+{
+  std::size_t seen = 0;
+
+  while (true) {
+    const std::function<void(int)>* task = nullptr;
+
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _start.wait(lock, [&] { return _stopping || _generation != seen; });
+
+      if (_stopping) {
+        return;
+      }
+
+      seen = _generation;
+      task = _task;
+    }
+
+    (*task)(worker);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _remaining -= 1;
+    }
+
+    _done.notify_one();
+  }
+}
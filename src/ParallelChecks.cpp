@@ -0,0 +1,169 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/generic/BreadthFirstSearch.h"
+#include "../include/generic/DeltaStepping.h"
+#include "../include/generic/ParallelBreadthFirstSearch.h"
+#include "../include/generic/ShortestPaths.h"
+#include "../include/generic/SpanningForest.h"
+#include "../include/imageops/GridGraph.h"
+#include "../include/util/Parallel.h"
+
+// Checks the parallel graph algorithms against their serial references on
+// 4- and 8-connected lattices, across several thread counts. Weights are
+// drawn from a small range, so ties are everywhere, and some edges are
+// left out, so the lattices fall apart into several components.
+
+namespace {
+const int ThreadCounts[] = { 1, 2, 3, 8 };
+
+const Neighborhood Lattices[] = { Neighborhood::Neumann, Neighborhood::Moore };
+
+int failures = 0;
+
+void
+check(bool passed, const char* what, Neighborhood nbr, int threads)
+{
+  if (!passed) {
+    std::cout << what << " differs from its serial reference on the "
+              << (nbr == Neighborhood::Moore ? "Moore" : "Neumann")
+              << " lattice with " << threads << " threads\n";
+    failures += 1;
+  }
+}
+
+GridGraph
+makeLattice(int width,
+            int height,
+            Neighborhood nbr,
+            int maxWeight,
+            int missingPercent,
+            std::uint32_t seed)
+{
+  GridGraph grid(width, height, nbr);
+  std::mt19937 gen(seed);
+
+  for (GridGraph::Index v = 0; v < grid.size(); v += 1) {
+    for (int dir = 0; dir < grid.directions(); dir += 1) {
+      if (static_cast<int>(gen() % 100) >= missingPercent) {
+        grid.setWeight(v, dir, gen() % (maxWeight + 1));
+      }
+    }
+  }
+
+  return grid;
+}
+
+bool
+sameEdges(const std::vector<WeightedEdge>& forest1,
+          const std::vector<WeightedEdge>& forest2)
+{
+  if (forest1.size() != forest2.size()) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < forest1.size(); i += 1) {
+    if (forest1[i].from != forest2[i].from || forest1[i].to != forest2[i].to ||
+        forest1[i].weight != forest2[i].weight) {
+      return false;
+    }
+  }
+
+  return true;
+}
+} // namespace
+
+void
+testSpanningForest()
+{
+  for (auto nbr : Lattices) {
+    auto grid = makeLattice(97, 61, nbr, 3, 20, 1);
+
+    WorkerPool serial(1);
+    SpanningForest<GridGraph> reference(grid, serial);
+    reference.runKruskal();
+
+    for (int threads : ThreadCounts) {
+      WorkerPool pool(threads);
+      SpanningForest<GridGraph> forest(grid, pool);
+      forest.run();
+
+      check(sameEdges(forest.edges(), reference.edges()),
+            "Boruvka spanning forest",
+            nbr,
+            threads);
+    }
+  }
+}
+
+void
+testDeltaStepping()
+{
+  // small weights take the bucket queue of ShortestPaths, large ones its
+  // heap, and delta 0 picks one from the largest weight
+  for (auto nbr : Lattices) {
+    for (int maxWeight : { 3, 9000 }) {
+      auto grid = makeLattice(131, 77, nbr, maxWeight, 10, 2);
+
+      ShortestPaths<GridGraph> reference(grid);
+      reference.run(grid.index(65, 38));
+
+      for (int threads : ThreadCounts) {
+        for (int delta : { 0, 1, 50 }) {
+          WorkerPool pool(threads);
+          DeltaStepping<GridGraph> paths(grid, pool, delta);
+          paths.run(grid.index(65, 38));
+
+          check(paths.distances() == reference.distances(),
+                "delta stepping",
+                nbr,
+                threads);
+        }
+      }
+    }
+  }
+}
+
+void
+testParallelBreadthFirstSearch()
+{
+  // the dense lattice grows frontiers large enough for bottom-up steps
+  for (auto nbr : Lattices) {
+    for (int missingPercent : { 5, 40 }) {
+      auto grid = makeLattice(300, 200, nbr, 1, missingPercent, 3);
+
+      BreadthFirstSearch<GridGraph> reference(grid);
+      reference.run(grid.index(150, 100), true);
+
+      for (int threads : ThreadCounts) {
+        WorkerPool pool(threads);
+        ParallelBreadthFirstSearch<GridGraph> search(grid, pool);
+        search.run(grid.index(150, 100));
+
+        check(search.levels() == reference.levels() &&
+                search.reached() == reference.order().size(),
+              "direction-optimizing BFS",
+              nbr,
+              threads);
+      }
+    }
+  }
+}
+
+int
+main()
+{
+  testSpanningForest();
+  testDeltaStepping();
+  testParallelBreadthFirstSearch();
+
+  if (failures > 0) {
+    std::cout << failures << " checks failed\n";
+    return 1;
+  }
+
+  std::cout << "all checks passed\n";
+  return 0;
+}